@@ -9,18 +9,34 @@
 #include <new>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 
 // --- Specification indices ---
 enum SpecIndex {
     SPEC_GROUPS = 0,
     SPEC_DESTINATIONS,
+    SPEC_INPUTS,
+    SPEC_MAX_DELAY,
+    SPEC_GLOBAL_MIDI,
+    SPEC_CHANNELS,
+    // Optional per-group feature blocks (0 = absent; absent params read as 0)
+    SPEC_DUCKING,        // Priority, Duck
+    SPEC_ENVELOPE,       // Env control types and their follower params
+    SPEC_MODULATION,     // Mod Source/Rate/Clock, Volume/Pan/Fade CV
+    SPEC_CTRL_OPTIONS,   // Arbitration, Zones and the zone starts
+    SPEC_AUX_SEND,       // Aux L/R/Level/Tap
+    SPEC_MID_SIDE,       // Routing, Side Dest
+    SPEC_FADE_OPTIONS,   // Adaptive curve with Correlation, Fade Out, Retrigger
     NUM_SPECS
 };
 
 // --- Hardware limits ---
 constexpr int MAX_GROUPS        = 4;
 constexpr int MAX_DESTINATIONS  = 4;
+constexpr int MAX_INPUTS        = 4;   // Input pairs summed per group
+constexpr int MAX_DELAY_MS      = 100; // Latency compensation ceiling
 constexpr int MAX_BUSSES        = 28;
+constexpr int MAX_CHANNELS      = 8;   // Group array width
 
 // --- Control types ---
 enum ControlType {
@@ -30,11 +46,14 @@ enum ControlType {
     CTRL_TRIG_REV,      // Rising edge cycles backwards
     CTRL_GATE,          // Low=Dest1, High=Dest2
     CTRL_GATE_REV,      // Low=Dest2, High=Dest1
+    CTRL_ENV,           // Input level: below threshold=Dest1, above=Dest2
+    CTRL_ENV_REV,       // Input level: below threshold=Dest2, above=Dest1
     CTRL_TYPE_COUNT
 };
 
 static const char* const controlTypeStrings[] = {
-    "Unipolar", "Bipolar", "Trigger", "Trig Rev", "Gate", "Gate Rev", nullptr
+    "Unipolar", "Bipolar", "Trigger", "Trig Rev", "Gate", "Gate Rev",
+    "Env", "Env Rev", nullptr
 };
 
 // --- Crossfade curves (for smooth transitions between destinations) ---
@@ -42,11 +61,112 @@ enum CrossfadeCurve {
     CURVE_LINEAR = 0,
     CURVE_EQUAL_POWER,
     CURVE_S_CURVE,
+    CURVE_ADAPTIVE,     // Constant power for the Correlation parameter
     CURVE_COUNT
 };
 
 static const char* const curveStrings[] = {
-    "Linear", "Equal Power", "S-Curve", nullptr
+    "Linear", "Equal Power", "S-Curve", "Adaptive", nullptr
+};
+
+// --- Internal modulation source (replaces the control CV) ---
+enum ModSource {
+    MOD_OFF = 0,
+    MOD_SINE,
+    MOD_TRI,
+    MOD_SAW,
+    MOD_RANDOM,         // Random step, new value each cycle
+    MOD_SOURCE_COUNT
+};
+
+static const char* const modSourceStrings[] = {
+    "Off", "Sine", "Tri", "Saw", "Random", nullptr
+};
+
+// --- Output clipper (applied once per destination bus after all groups) ---
+enum OutputClip {
+    CLIP_OFF = 0,
+    CLIP_CUBIC,         // Cubic polynomial, reaches the level at 1.5x
+    CLIP_TANH,          // Rational tanh approximation
+    CLIP_COUNT
+};
+
+static const char* const clipStrings[] = {
+    "Off", "Cubic", "Tanh", nullptr
+};
+
+// --- Control source arbitration ---
+// Sources that can select a group's destination
+enum ControlSource {
+    SRC_CONTROL = 0,    // Control CV, Env follower or Mod source
+    SRC_MIDI,
+    SRC_PARAM,          // Active Dest parameter
+    SRC_COUNT
+};
+
+enum ArbitrationMode {
+    ARB_LAST_TOUCHED = 0,  // Whichever source changed most recently
+    ARB_PRIORITY,          // Control, then MIDI, then Active Dest
+    ARB_OFFSET,            // MIDI/Active Dest selects, Control steps onward from it
+    ARB_MODE_COUNT
+};
+
+static const char* const arbitrationStrings[] = {
+    "Last Touched", "Priority", "CV+MIDI", nullptr
+};
+
+// --- Control zones (Unipolar/Bipolar) ---
+enum ZoneMode {
+    ZONES_EQUAL = 0,    // Range split evenly across the destinations
+    ZONES_CUSTOM,       // Zone N Start breakpoints, compiled to a lookup table
+    ZONE_MODE_COUNT
+};
+
+static const char* const zoneModeStrings[] = {
+    "Equal", "Custom", nullptr
+};
+
+// --- Aux send tap point ---
+enum AuxTap {
+    AUX_PRE = 0,        // After Volume/Pan, regardless of routing
+    AUX_POST,           // Follows the routed gain (fades, ducking, unassigned dests)
+    AUX_TAP_COUNT
+};
+
+static const char* const auxTapStrings[] = {
+    "Pre", "Post", nullptr
+};
+
+// --- Group routing mode ---
+enum RoutingMode {
+    ROUTING_NORMAL = 0,   // Inputs summed and routed as one signal
+    ROUTING_MID_SIDE,     // Mid to Active Dest, side to Side Dest
+    ROUTING_MODE_COUNT
+};
+
+static const char* const routingStrings[] = {
+    "Normal", "Mid/Side", nullptr
+};
+
+// --- What a new target does to a fade still in progress ---
+enum RetriggerPolicy {
+    RETRIG_CHASE = 0,   // Every open destination chases the new target
+    RETRIG_RESTART,     // The loudest outgoing destination fades on, the rest are killed
+    RETRIG_FAST_KILL,   // All outgoing destinations are killed
+    RETRIG_QUEUE,       // The new target waits for the fade to finish
+    RETRIGGER_POLICY_COUNT
+};
+
+static const char* const retriggerStrings[] = {
+    "Chase", "Restart", "Fast Kill", "Queue", nullptr
+};
+
+// --- CPU governor quality levels (cheapest last) ---
+enum GovernorLevel {
+    GOV_FULL = 0,       // Per-sample slew and envelope follower
+    GOV_LINEAR,         // Block-rate slew/env, gains ramped linearly per block
+    GOV_COARSE,         // Block-rate slew/env, gains held constant per block
+    GOV_LEVEL_COUNT
 };
 
 // Off/On strings for enable parameters
@@ -57,6 +177,50 @@ static const char* const offOnStrings[] = {
 // --- Constants ---
 constexpr float TRIGGER_THRESHOLD = 2.5f;
 constexpr float GATE_THRESHOLD    = 2.5f;
+constexpr float DUCK_TIME_SEC     = 0.05f;  // Duck attack/release time constant
+constexpr int   MAX_PRIORITY      = 7;
+constexpr int   MAX_DUCK_DB       = 40;
+constexpr float ENV_REF_VOLTS     = 10.0f;  // 0 dB envelope threshold
+constexpr float MOD_CLOCK_THRESHOLD = 1.0f;
+constexpr int   ZONE_LUT_SIZE     = 500;    // 20 mV cells over the 10 V control range
+constexpr float ZONE_RANGE_VOLTS  = 10.0f;
+constexpr float KILL_GAIN         = 0.00005f; // Retrigger: killed destinations are below this after a block
+constexpr float QUEUE_DONE_GAIN   = 0.001f; // Queue: outgoing gain (-60 dB) that ends a fade
+
+// --- Correlation-aware crossfade ---
+constexpr int   CURVE_X_STEPS     = 32;     // Table cells along the fade position
+constexpr int   CURVE_RHO_STEPS   = 16;     // ...and along the correlation
+
+// --- CPU governor ---
+constexpr float CPU_CLOCK_HZ      = 600000000.0f;  // Disting NT core clock
+constexpr float GOV_AVERAGE_SEC   = 0.05f;  // Load smoothing time constant
+constexpr float GOV_RESTORE_RATIO = 0.6f;   // Restore quality below this share of the budget...
+constexpr float GOV_RESTORE_SEC   = 0.5f;   // ...sustained this long
+constexpr float GOV_SETTLE_SEC    = 0.1f;   // No further change for this long after a step
+
+// --- Gesture recorder ---
+enum GestureMode {
+    GESTURE_OFF = 0,
+    GESTURE_RECORD,
+    GESTURE_PLAY,
+    GESTURE_MODE_COUNT
+};
+
+static const char* const gestureStrings[] = {
+    "Off", "Record", "Play", nullptr
+};
+
+// Events are packed as (delta samples << GESTURE_DEST_BITS) | dest
+constexpr int      GESTURE_MAX_EVENTS = 1024;  // per group, in DRAM
+constexpr int      GESTURE_DEST_BITS  = 4;
+constexpr uint32_t GESTURE_DEST_MASK  = (1u << GESTURE_DEST_BITS) - 1;
+constexpr uint32_t GESTURE_MAX_DELTA  = 0xFFFFFFFFu >> GESTURE_DEST_BITS;
+static_assert(MAX_DESTINATIONS <= (1 << GESTURE_DEST_BITS), "Gesture dest field too narrow");
+
+// Follow Group: 0 = Off, otherwise an earlier group to follow
+static const char* const followStrings[] = {
+    "Off", "Group 1", "Group 2", "Group 3", nullptr
+};
 
 // Simple clamp helper (C++11-safe)
 template<typename T>
@@ -76,7 +240,7 @@ static float getSampleRateFloat() {
 }
 
 // --- Parameter indices per group ---
-// Note: Actual number of dest params depends on SPEC_DESTINATIONS
+// Note: Actual number of dest/input/delay params depends on the specifications
 enum GroupParamOffset {
     GP_INPUT_L = 0,     // Input left/mono
     GP_INPUT_R,         // Input right (0 = mono, use L for both)
@@ -99,6 +263,47 @@ enum GroupParamOffset {
     GP_MIDI_ENABLE,
     GP_MIDI_CHANNEL,
     GP_MIDI_CC,
+    GP_GESTURE,         // Gesture recorder: Off/Record/Play
+    GP_FOLLOW,          // Follow Group: reuse an earlier group's gain envelope
+    GP_INPUT2_L,        // Extra input pairs (SPEC_INPUTS > 1) start here
+    GP_INPUT2_R,
+    GP_INPUT2_LEVEL,
+    GP_INPUT3_L,
+    GP_INPUT3_R,
+    GP_INPUT3_LEVEL,
+    GP_INPUT4_L,
+    GP_INPUT4_R,
+    GP_INPUT4_LEVEL,
+    GP_PRIORITY,        // Ducking priority (higher ducks lower)
+    GP_DUCK,            // Duck depth applied to lower-priority groups (dB)
+    GP_ENV_THRESHOLD,   // Env control: level threshold (dB re 10V)
+    GP_ENV_ATTACK,      // Env control: attack (ms)
+    GP_ENV_RELEASE,     // Env control: release (ms)
+    GP_ENV_HOLD,        // Env control: hold above threshold (ms)
+    GP_MOD_SOURCE,      // Internal LFO/random source (Off = use Control)
+    GP_MOD_RATE,        // Mod rate in 0.01 Hz
+    GP_MOD_CLOCK,       // Mod clock input (0 = free running)
+    GP_ARBITRATION,     // How Control, MIDI and Active Dest share the group
+    GP_ZONES,           // Equal or Custom control zones
+    GP_ZONE2_START,     // Custom zone breakpoints in 0.1 V (numDests - 1 present)
+    GP_ZONE3_START,
+    GP_ZONE4_START,
+    GP_AUX_L,           // Aux send bus (0 = off)
+    GP_AUX_R,
+    GP_AUX_LEVEL,       // Aux send level (0..106)
+    GP_AUX_TAP,         // Pre/Post route
+    GP_ROUTING,         // Normal or Mid/Side
+    GP_SIDE_DEST,       // Mid/Side: destination of the side signal (1 to numDests)
+    GP_CORRELATION,     // Adaptive curve: correlation of the destinations (%)
+    GP_VOLUME_CV,       // Modulation CV busses (0 = none), decoded at the CV Rate
+    GP_PAN_CV,
+    GP_FADE_CV,
+    GP_FADE_OUT,        // Fade-out amount 0..10 (0 = same as the fade-in)
+    GP_RETRIGGER,       // RetriggerPolicy
+    GP_DEST1_DELAY,     // Latency compensation in samples (SPEC_MAX_DELAY > 0)
+    GP_DEST2_DELAY,
+    GP_DEST3_DELAY,
+    GP_DEST4_DELAY,
     PARAMS_PER_GROUP_MAX  // Maximum - actual count depends on numDests
 };
 
@@ -106,10 +311,51 @@ enum GroupParamOffset {
 enum GlobalParam {
     PARAM_BYPASS = 0,
     PARAM_GLOBAL_SLEW,     // Global fade amount 0..10
-    GLOBAL_PARAM_COUNT
+    PARAM_OUTPUT_CLIP,     // Destination bus soft clipper
+    PARAM_CLIP_LEVEL,      // Clipper ceiling in 0.1V
+    PARAM_CPU_BUDGET,      // Governor budget, % of block time (0 = off)
+    PARAM_CV_RATE,         // Volume/Pan/Fade CV decode rate (Hz)
+    GLOBAL_PARAM_COUNT,
+    // Global MIDI spec only: replaces the per-group MIDI params
+    PARAM_MIDI_ENABLE = GLOBAL_PARAM_COUNT,
+    PARAM_MIDI_CHANNEL,
+    PARAM_MIDI_BASE_CC,    // Group g listens to CC base + g
+    GLOBAL_PARAM_MAX
+};
+
+// Per-group MIDI params and the Global MIDI ones are never present together
+constexpr size_t MIDI_PARAMS_PER_GROUP = GP_MIDI_CC - GP_MIDI_ENABLE + 1;
+constexpr size_t MAX_PARAMS_GROUP_MIDI  = GLOBAL_PARAM_COUNT + MAX_GROUPS * PARAMS_PER_GROUP_MAX;
+constexpr size_t MAX_PARAMS_GLOBAL_MIDI = GLOBAL_PARAM_MAX
+                                        + MAX_GROUPS * (PARAMS_PER_GROUP_MAX - MIDI_PARAMS_PER_GROUP);
+constexpr size_t MAX_PARAMS = (MAX_PARAMS_GROUP_MIDI > MAX_PARAMS_GLOBAL_MIDI)
+                            ? MAX_PARAMS_GROUP_MIDI : MAX_PARAMS_GLOBAL_MIDI;
+static_assert(MAX_PARAMS <= 256, "Page parameter indices are uint8_t");
+
+// --- Gesture recorder/looper state ---
+// Destination changes are stored delta-encoded in a DRAM event buffer.
+// `pos` is the sample position within the loop (record or playback).
+struct GestureState {
+    uint32_t* events   = nullptr;  // GESTURE_MAX_EVENTS words, owned by DRAM
+    uint16_t  count    = 0;        // Recorded events
+    uint16_t  cursor   = 0;        // Next event to play
+    uint32_t  length   = 0;        // Loop length in samples (0 = empty)
+    uint32_t  pos      = 0;        // Position within loop
+    uint32_t  nextAt   = 0;        // Play: loop time of event at cursor
+    uint32_t  lastAt   = 0;        // Record: loop time of last event
+    uint8_t   dest     = 0;        // Play: current destination / Record: last recorded
+    uint8_t   mode     = GESTURE_OFF;
 };
 
-constexpr size_t MAX_PARAMS = GLOBAL_PARAM_COUNT + (MAX_GROUPS * PARAMS_PER_GROUP_MAX);
+// --- Internal modulation source state ---
+struct ModState {
+    float    phase     = 0.0f;         // 0..1
+    float    held      = 0.0f;         // Random step value 0..1
+    uint32_t seed      = 0x9E3779B9u;  // xorshift32
+    uint32_t sinceEdge = 0;            // Samples since last clock edge
+    uint32_t period    = 0;            // Measured clock period (0 = none yet)
+    bool     lastClockHigh = false;
+};
 
 // --- Per-group runtime state ---
 struct MixerGroupState {
@@ -117,10 +363,85 @@ struct MixerGroupState {
     int   targetDest   = 0;  // Target destination
     float destGains[MAX_DESTINATIONS]   = { 1.0f, 0.0f, 0.0f, 0.0f };  // Gain per destination
     float targetGains[MAX_DESTINATIONS] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    float duckGain[MAX_DESTINATIONS]    = { 1.0f, 1.0f, 1.0f, 1.0f };  // Ducking per destination
+    // Mid/Side: the side signal's own gain set (the mid uses destGains)
+    int   sideDest = -1;  // -1 = gains not yet snapped to a target
+    float sideGains[MAX_DESTINATIONS]       = {};
+    float sideTargetGains[MAX_DESTINATIONS] = {};
+    // Volume/Pan CV: output gains ramped to the value decoded at each CV tick
+    bool  cvActive   = false;
+    float cvGainL    = 0.0f;
+    float cvGainR    = 0.0f;
+    float cvIncL     = 0.0f;  // Per sample
+    float cvIncR     = 0.0f;
+    float cvSlewRate = 1.0f;  // Fade CV: rise and fall rates decoded at the last tick
+    float cvFallRate = 1.0f;
+    // Retrigger: policy applied by setTargetDest(), and destinations being killed
+    uint8_t  retrigger = RETRIG_CHASE;
+    uint32_t killMask  = 0;
     bool  lastTriggerHigh = false;
     uint8_t lastMidiValue = 0;
+    // Arbitration: the target is only re-resolved when a source changes
+    int8_t  srcDest[SRC_COUNT] = { 0, 0, 0 };  // Last destination from each source
+    uint8_t srcValid    = 1u << SRC_PARAM;     // Sources that have produced one
+    uint8_t lastTouched = SRC_PARAM;
+    uint8_t lastManual  = SRC_PARAM;           // MIDI or Active Dest, whichever moved last
+    bool    arbPending  = true;
+    float env       = 0.0f;  // Env control: peak follower output
+    int   envHold   = 0;     // Env control: hold samples remaining
+    ModState mod;
+    uint32_t delayWrite[MAX_DESTINATIONS] = {};  // Ring write index per destination
+    int32_t  delayTail[MAX_DESTINATIONS]  = {};  // Samples left to flush after going idle
+    int32_t  delayUsed[MAX_DESTINATIONS]  = {};  // Delay the ring last ran with (0 = bypassed)
+    GestureState gesture;
+};
+
+// --- Parameter-derived values ---
+// parameterChanged() only marks groups dirty; step() rebuilds these once per
+// block for the dirty groups, so preset loads and CV-mapped parameter storms
+// never pay for pow/exp/trig per change.
+struct GroupCoeffs {
+    float inGain[MAX_INPUTS];  // 0.5 * level * volume per input pair (0 = unused)
+    float panGL;
+    float panGR;
+    float slewRate;            // Per-sample fade-in coefficient (1 = hard switch)
+    float fallRate;            // Per-sample fade-out coefficient (= slewRate unless Fade Out)
+    RetriggerPolicy retrigger;
+    float duckDepth;           // Gain applied to lower-priority groups (1 = off)
+    float envAttack;           // Peak follower attack coefficient
+    float envRelease;          // Peak follower release multiplier
+    float envThreshold;        // Env control threshold in volts
+    int   envHoldSamples;
+    float modRateHz;
+    ControlType ctrlType;
+    ModSource   modSource;
+    ArbitrationMode arbMode;
+    bool    customZones;            // Unipolar/Bipolar control reads zoneLut
+    uint8_t zoneLut[ZONE_LUT_SIZE]; // Destination per 20 mV cell of the control range
+    float   auxGain;                // Aux send level (0 = off)
+    bool    auxPost;
+    bool    midSide;
+    int     sideDest;               // 0-based
+    CrossfadeCurve curve;
+    float   correlation;            // Adaptive curve, 0..1
+    bool    modCv;                  // Any Volume/Pan/Fade CV bus set
+    bool    fadeCv;
+    float   panNorm;                // Pan parameter, -1..1
+    float   fadeAmt;                // Effective Fade parameter, 0..10
+    float   fadeOutAmt;             // Effective fade-out amount, 0..10
+    bool    xfade;                  // Dest Xfade
+    float slewDecay;           // Governor: (1 - slewRate)^slewFrames
+    float fallDecay;           // Governor: (1 - fallRate)^slewFrames
+    int   slewFrames;          // Block size the decays were computed for (0 = stale)
+    float killRate;            // Retrigger: closes a killed destination within killFrames
+    float killDecay;           // (1 - killRate)^killFrames
+    int   killFrames;          // Block size killRate was computed for (0 = stale)
 };
 
+// Dirty bits: one per group, plus the tables shared across groups
+constexpr uint32_t DIRTY_SHARED = 1u << MAX_GROUPS;
+constexpr uint32_t DIRTY_ALL    = (DIRTY_SHARED << 1) - 1;
+
 /* ───── specifications ───── */
 static const _NT_specification gSpecs[] = {
     {
@@ -136,6 +457,83 @@ static const _NT_specification gSpecs[] = {
         .max = MAX_DESTINATIONS,
         .def = 2,
         .type = kNT_typeGeneric
+    },
+    {
+        .name = "Inputs",
+        .min = 1,
+        .max = MAX_INPUTS,
+        .def = 1,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Max Delay ms",
+        .min = 0,
+        .max = MAX_DELAY_MS,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Global MIDI",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Channels",
+        .min = 1,
+        .max = MAX_CHANNELS,
+        .def = 1,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Ducking",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Envelope",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Modulation",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Ctrl Options",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Aux Send",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Mid/Side",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
+    },
+    {
+        .name = "Fade Options",
+        .min = 0,
+        .max = 1,
+        .def = 0,
+        .type = kNT_typeGeneric
     }
 };
 static_assert(NUM_SPECS == sizeof(gSpecs) / sizeof(gSpecs[0]), "Spec count mismatch");
@@ -144,19 +542,53 @@ static_assert(NUM_SPECS == sizeof(gSpecs) / sizeof(gSpecs[0]), "Spec count misma
 struct SwitchingMixer : _NT_algorithm {
     uint8_t numGroups;
     uint8_t numDests;
+    uint8_t numInputs;       // Input pairs per group
+    uint8_t numGlobals;      // Global params (more with the Global MIDI spec)
+    uint8_t numChannels;     // Group array width (1 = normal groups)
     uint8_t paramsPerGroup;  // Actual params per group (depends on numDests)
+    uint32_t maxFrames;      // Frames per gain buffer (NT_globals.maxFramesPerStep)
+    float*  gainBuffers;     // Per-sample dest gains of leader groups (DRAM)
+    uint32_t maxDelay;       // Latency compensation ceiling in samples (0 = off)
+    uint32_t delayRingSize;  // maxDelay + maxFrames
+    float*  delayRings;      // L/R ring per group and destination (DRAM)
+    float*  delayScratch;    // Block scratch per destination L/R, kept zeroed (DRAM)
+    int8_t  gpOffset[PARAMS_PER_GROUP_MAX];  // GroupParamOffset -> offset in group (-1 = absent)
     MixerGroupState groupState[MAX_GROUPS];
-    _NT_parameter params[MAX_PARAMS];
+    
+    // Lazily rebuilt from v[] (see GroupCoeffs)
+    uint32_t    dirty;
+    GroupCoeffs coeffs[MAX_GROUPS];
+    int8_t      leader[MAX_GROUPS];        // Root of each group's follow chain
+    bool        hasFollowers[MAX_GROUPS];
+    bool        anyDuck;
+    int16_t     midiKey[MAX_GROUPS];       // Per-group MIDI: (channel << 7) | CC, -1 = off
+    OutputClip  clipType;
+    float       clipLevel;
+    
+    // CPU governor
+    uint8_t     govLevel;       // GovernorLevel applied to every leader group
+    float       govLoad;        // Smoothed share of the block time spent in step()
+    uint32_t    govCalm;        // Frames spent under the restore threshold
+    uint32_t    govSettle;      // Frames left before the level may change again
+    
+    int         cvBlocks;       // Blocks since the last modulation CV tick
+    
+    // Parameters and their page index lists follow the instance in SRAM,
+    // sized by calcReq for the specifications (see sramSize)
+    _NT_parameter* params;
+    uint8_t*       pageIndices;     // pageIndices[i] = i; each page takes a slice
     
     // Parameter pages
     _NT_parameterPage pageDefs[MAX_GROUPS + 1];  // Global + up to 4 groups
     _NT_parameterPages pagesStruct;
-    
-    // Parameter indices for each page (sized for max)
-    uint8_t globalParamIndices[GLOBAL_PARAM_COUNT];
-    uint8_t groupParamIndices[MAX_GROUPS][PARAMS_PER_GROUP_MAX];
 
-    SwitchingMixer() : numGroups(1), numDests(2), paramsPerGroup(0) {}
+    SwitchingMixer() : numGroups(1), numDests(2), numInputs(1),
+                       numGlobals(GLOBAL_PARAM_COUNT), numChannels(1), paramsPerGroup(0),
+                       maxFrames(0), gainBuffers(nullptr), maxDelay(0),
+                       delayRingSize(0), delayRings(nullptr), delayScratch(nullptr),
+                       dirty(DIRTY_ALL), coeffs(), anyDuck(false), clipType(CLIP_OFF), clipLevel(10.0f),
+                       govLevel(GOV_FULL), govLoad(0.0f), govCalm(0), govSettle(0),
+                       cvBlocks(0), params(nullptr), pageIndices(nullptr) {}
 };
 
 /* ───── helpers ───── */
@@ -164,6 +596,10 @@ static inline float* bus(float* b, int bus_idx, int N) {
     return (bus_idx > 0) ? (b + (bus_idx - 1) * N) : nullptr;
 }
 
+static inline uint32_t busBit(int bus_idx) {
+    return (bus_idx > 0 && bus_idx <= MAX_BUSSES) ? (1u << (bus_idx - 1)) : 0;
+}
+
 static inline void setParam(_NT_parameter& p, const char* name,
                             int16_t min, int16_t max, int16_t def, uint8_t unit) {
     p.name   = name;
@@ -191,17 +627,232 @@ static inline float dbToGain(float db) {
     return std::pow(10.0f, db / 20.0f);
 }
 
+// Volume/level 0..106 (0=off, 100=0dB, 106=+6dB)
+static inline float levelToGain(int raw) {
+    return (raw <= 0) ? 0.0f : dbToGain((float)raw - 100.0f);
+}
+
+// Group arrays (Channels > 1) are mono, unpanned and undelayed, with one
+// input run and no aux or mid/side, so these params would do nothing
+static bool ignoredByArrays(int gp) {
+    switch (gp) {
+        case GP_INPUT_R:
+        case GP_PAN:
+        case GP_ROUTING:
+        case GP_SIDE_DEST:
+        case GP_VOLUME_CV:
+        case GP_PAN_CV:
+            return true;
+        default:
+            break;
+    }
+    return (gp >= GP_DEST1_R && gp <= GP_DEST4_R && (gp - GP_DEST1_R) % 2 == 0)
+        || (gp >= GP_INPUT2_L && gp <= GP_INPUT4_LEVEL)
+        || (gp >= GP_AUX_L && gp <= GP_AUX_TAP)
+        || (gp >= GP_DEST1_DELAY && gp <= GP_DEST4_DELAY);
+}
+
+// Lays out one group's parameters in GroupParamOffset order.
+// Fills offsets (-1 for params not present) and returns the param count.
+static int groupLayout(int8_t* offsets, const int32_t* sp) {
+    const int  dests  = sp[SPEC_DESTINATIONS];
+    const int  inputs = sp[SPEC_INPUTS];
+    const bool array  = sp[SPEC_CHANNELS] > 1;
+    int n = 0;
+    for (int gp = 0; gp < PARAMS_PER_GROUP_MAX; ++gp) {
+        bool present = true;
+        if (array && ignoredByArrays(gp)) {
+            present = false;
+        } else if (gp >= GP_DEST1_L && gp < GP_DEST1_L + MAX_DESTINATIONS * 2) {
+            present = gp < GP_DEST1_L + dests * 2;
+        } else if (gp >= GP_INPUT2_L && gp <= GP_INPUT4_LEVEL) {
+            present = gp < GP_INPUT2_L + (inputs - 1) * 3;
+        } else if (gp >= GP_DEST1_DELAY && gp <= GP_DEST4_DELAY) {
+            present = sp[SPEC_MAX_DELAY] > 0 && gp < GP_DEST1_DELAY + dests;
+        } else if (gp >= GP_MIDI_ENABLE && gp <= GP_MIDI_CC) {
+            present = !sp[SPEC_GLOBAL_MIDI];
+        } else if (gp == GP_PRIORITY || gp == GP_DUCK) {
+            present = sp[SPEC_DUCKING];
+        } else if (gp >= GP_ENV_THRESHOLD && gp <= GP_ENV_HOLD) {
+            present = sp[SPEC_ENVELOPE];
+        } else if ((gp >= GP_MOD_SOURCE && gp <= GP_MOD_CLOCK)
+                   || (gp >= GP_VOLUME_CV && gp <= GP_FADE_CV)) {
+            present = sp[SPEC_MODULATION];
+        } else if (gp == GP_ARBITRATION || gp == GP_ZONES) {
+            present = sp[SPEC_CTRL_OPTIONS];
+        } else if (gp >= GP_ZONE2_START && gp <= GP_ZONE4_START) {
+            present = sp[SPEC_CTRL_OPTIONS] && gp < GP_ZONE2_START + dests - 1;
+        } else if (gp >= GP_AUX_L && gp <= GP_AUX_TAP) {
+            present = sp[SPEC_AUX_SEND];
+        } else if (gp == GP_ROUTING || gp == GP_SIDE_DEST) {
+            present = sp[SPEC_MID_SIDE];
+        } else if (gp == GP_CORRELATION || gp == GP_FADE_OUT || gp == GP_RETRIGGER) {
+            present = sp[SPEC_FADE_OPTIONS];
+        }
+        offsets[gp] = present ? (int8_t)n++ : (int8_t)-1;
+    }
+    return n;
+}
+
+// A group param's value; absent params read as 0, which every optional
+// block treats as off
+static inline int16_t groupParam(const SwitchingMixer* self, int base, int gp) {
+    const int off = self->gpOffset[gp];
+    return (off >= 0) ? self->v[base + off] : 0;
+}
+
+// Highest value a group param accepts: Ctrl Type and Curve lose their
+// last entries when the Envelope or Fade Options spec is off
+static inline int groupParamMax(const SwitchingMixer* self, int base, int gp) {
+    return self->params[base + self->gpOffset[gp]].max;
+}
+
+static inline int globalParamCount(const int32_t* sp) {
+    return sp[SPEC_GLOBAL_MIDI] ? GLOBAL_PARAM_MAX : GLOBAL_PARAM_COUNT;
+}
+
+// SRAM: the instance, then one _NT_parameter and one page index per parameter
+static inline uint32_t sramSize(uint32_t numParameters) {
+    return sizeof(SwitchingMixer) + numParameters * (sizeof(_NT_parameter) + sizeof(uint8_t));
+}
+
+// Index of a group's first parameter
+static inline int groupBase(const SwitchingMixer* self, int g) {
+    return self->numGlobals + g * self->paramsPerGroup;
+}
+
+// Retrigger: before `dest` becomes the target, kills outgoing destinations
+// so at most one keeps fading. Restart and Queue keep the loudest; Fast Kill
+// keeps none if a fade was still in progress.
+static void limitOpenDests(MixerGroupState& state, int dest, int numDests) {
+    uint32_t open    = 0;
+    int      loudest = -1;
+    bool     midFade = false;
+    for (int d = 0; d < numDests; ++d) {
+        const bool isOpen = state.destGains[d] > 0.0001f;
+        midFade |= isOpen && d != state.targetDest;
+        if (isOpen && d != dest) {
+            open |= 1u << d;
+            if (loudest < 0 || state.destGains[d] > state.destGains[loudest]) {
+                loudest = d;
+            }
+        }
+    }
+    uint32_t kill = 0;
+    if (state.retrigger == RETRIG_FAST_KILL) {
+        kill = midFade ? open : 0;
+    } else if (loudest >= 0) {
+        kill = open & ~(1u << loudest);
+    }
+    state.killMask = (state.killMask | kill) & ~(1u << dest);
+}
+
+// Sets the one-hot target gains for a destination. Re-applying the current
+// destination is a no-op, so it never counts as a retrigger.
+static inline void setTargetDest(MixerGroupState& state, int dest, int numDests) {
+    if (dest == state.targetDest) {
+        return;
+    }
+    if (state.retrigger != RETRIG_CHASE) {
+        limitOpenDests(state, dest, numDests);
+    }
+    state.targetDest = dest;
+    for (int d = 0; d < numDests; ++d) {
+        state.targetGains[d] = (d == dest) ? 1.0f : 0.0f;
+    }
+}
+
+// Arrays have no Dest Delay params, so they get no delay memory either
+static inline uint32_t maxDelaySamples(const int32_t* sp) {
+    return (sp[SPEC_CHANNELS] > 1) ? 0 : (uint32_t)sp[SPEC_MAX_DELAY] * NT_globals.sampleRate / 1000;
+}
+
+// DRAM regions (byte offsets), shared by calcReq and construct
+struct DramLayout {
+    uint32_t gestureEvents;  // GESTURE_MAX_EVENTS words per group
+    uint32_t gainBuffers;    // numDests * maxFrames floats per group
+    uint32_t delayRings;     // 2 * numDests rings per group (Max Delay > 0)
+    uint32_t delayScratch;   // 2 * numDests * maxFrames floats (Max Delay > 0)
+    uint32_t total;
+};
+
+static DramLayout dramLayout(const int32_t* sp) {
+    const uint32_t groups    = sp[SPEC_GROUPS];
+    const uint32_t dests     = sp[SPEC_DESTINATIONS];
+    const uint32_t maxFrames = NT_globals.maxFramesPerStep;
+    const uint32_t maxDelay  = maxDelaySamples(sp);
+    const uint32_t ringSize  = (maxDelay > 0) ? maxDelay + maxFrames : 0;
+    
+    DramLayout l;
+    l.gestureEvents = 0;
+    l.gainBuffers   = l.gestureEvents + groups * GESTURE_MAX_EVENTS * sizeof(uint32_t);
+    l.delayRings    = l.gainBuffers + groups * dests * maxFrames * sizeof(float);
+    l.delayScratch  = l.delayRings + groups * dests * 2 * ringSize * sizeof(float);
+    l.total         = l.delayScratch + ((maxDelay > 0) ? dests * 2 * maxFrames * sizeof(float) : 0);
+    return l;
+}
+
+/* ───── crossfade curves ───── */
+// Square root for constant expressions: Newton's method from 1, exact to
+// double precision for the 0.5..1 arguments of the curve table
+static constexpr double constSqrt(double v) {
+    double r = 1.0;
+    for (int i = 0; i < 8; ++i) {
+        r = 0.5 * (r + v / r);
+    }
+    return r;
+}
+
+// Gain of a path at fade position x that keeps a two-path crossfade at
+// constant power for path correlation rho: 1 = linear, 0 = equal power.
+// Tabulated at compile time into flash, since the gains are only looked up
+// at segment ends; instances share it without any construct-time writes.
+struct CurveTable {
+    float gain[CURVE_RHO_STEPS + 1][CURVE_X_STEPS + 1];
+};
+
+static constexpr CurveTable makeCurveTable() {
+    CurveTable t = {};
+    for (int r = 0; r <= CURVE_RHO_STEPS; ++r) {
+        const double rho = (double)r / CURVE_RHO_STEPS;
+        for (int i = 0; i <= CURVE_X_STEPS; ++i) {
+            const double x = (double)i / CURVE_X_STEPS;
+            const double y = 1.0 - x;
+            t.gain[r][i] = (float)(x / constSqrt(x * x + y * y + 2.0 * rho * x * y));
+        }
+    }
+    return t;
+}
+
+static constexpr CurveTable gCurveTable = makeCurveTable();
+
+// Bilinear lookup; the ends are exact so settled gains stay 0 or 1
+static inline float curveGain(float x, float rho) {
+    if (x <= 0.0f || x >= 1.0f) {
+        return smxClamp(x, 0.0f, 1.0f);
+    }
+    const float fx = x * CURVE_X_STEPS;
+    const float fr = rho * CURVE_RHO_STEPS;
+    const int   i  = std::min((int)fx, CURVE_X_STEPS - 1);
+    const int   j  = std::min((int)fr, CURVE_RHO_STEPS - 1);
+    const float tx = fx - (float)i;
+    const float tr = fr - (float)j;
+    const float (*t)[CURVE_X_STEPS + 1] = gCurveTable.gain;
+    const float lo = t[j][i] + (t[j][i + 1] - t[j][i]) * tx;
+    const float hi = t[j + 1][i] + (t[j + 1][i + 1] - t[j + 1][i]) * tx;
+    return lo + (hi - lo) * tr;
+}
+
 /* ───── requirements ───── */
 static void calcReq(_NT_algorithmRequirements& r, const int32_t* sp) {
     const int groups = sp[SPEC_GROUPS];
-    const int dests  = sp[SPEC_DESTINATIONS];
     
-    // Params per group: 10 fixed + (dests * 2 for L/R) + 3 MIDI
-    const int paramsPerGroup = 10 + (dests * 2) + 3;
+    int8_t offsets[PARAMS_PER_GROUP_MAX];
+    const int paramsPerGroup = groupLayout(offsets, sp);
     
-    r.numParameters = GLOBAL_PARAM_COUNT + (groups * paramsPerGroup);
-    r.sram          = sizeof(SwitchingMixer);
-    r.dram          = 0;
+    r.numParameters = globalParamCount(sp) + (groups * paramsPerGroup);
+    r.sram          = sramSize(r.numParameters);
+    r.dram          = dramLayout(sp).total;
     r.dtc           = 0;
     r.itc           = 0;
 }
@@ -212,6 +863,7 @@ static _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& m,
                                  const int32_t* sp) {
     const uint8_t groups = sp[SPEC_GROUPS];
     const uint8_t dests  = sp[SPEC_DESTINATIONS];
+    const uint8_t inputs = sp[SPEC_INPUTS];
     
     if (groups < 1 || groups > MAX_GROUPS) {
         return nullptr;
@@ -219,12 +871,49 @@ static _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& m,
     if (dests < 2 || dests > MAX_DESTINATIONS) {
         return nullptr;
     }
+    if (inputs < 1 || inputs > MAX_INPUTS) {
+        return nullptr;
+    }
+    if (sp[SPEC_MAX_DELAY] < 0 || sp[SPEC_MAX_DELAY] > MAX_DELAY_MS) {
+        return nullptr;
+    }
+    if (sp[SPEC_GLOBAL_MIDI] < 0 || sp[SPEC_GLOBAL_MIDI] > 1) {
+        return nullptr;
+    }
+    if (sp[SPEC_CHANNELS] < 1 || sp[SPEC_CHANNELS] > MAX_CHANNELS) {
+        return nullptr;
+    }
+    for (int i = SPEC_DUCKING; i <= SPEC_FADE_OPTIONS; ++i) {
+        if (sp[i] < 0 || sp[i] > 1) {
+            return nullptr;
+        }
+    }
     
     SwitchingMixer* self = new (m.sram) SwitchingMixer();
     self->numGroups      = groups;
     self->numDests       = dests;
-    // 10 fixed params per group + dest pairs + 3 MIDI
-    self->paramsPerGroup = 10 + (dests * 2) + 3;
+    self->numInputs      = inputs;
+    self->numGlobals     = globalParamCount(sp);
+    self->numChannels    = sp[SPEC_CHANNELS];
+    self->paramsPerGroup = groupLayout(self->gpOffset, sp);
+    self->params         = reinterpret_cast<_NT_parameter*>(m.sram + sizeof(SwitchingMixer));
+    self->pageIndices    = reinterpret_cast<uint8_t*>(self->params + r.numParameters);
+    
+    self->maxFrames      = NT_globals.maxFramesPerStep;
+    
+    self->maxDelay       = maxDelaySamples(sp);
+    self->delayRingSize  = (self->maxDelay > 0) ? self->maxDelay + self->maxFrames : 0;
+    
+    // Gesture events, leader gain buffers and delay rings live in DRAM
+    const DramLayout dram = dramLayout(sp);
+    uint32_t* gestureEvents = reinterpret_cast<uint32_t*>(m.dram + dram.gestureEvents);
+    for (int g = 0; g < groups; ++g) {
+        self->groupState[g].gesture.events = gestureEvents + g * GESTURE_MAX_EVENTS;
+    }
+    self->gainBuffers  = reinterpret_cast<float*>(m.dram + dram.gainBuffers);
+    self->delayRings   = reinterpret_cast<float*>(m.dram + dram.delayRings);
+    self->delayScratch = reinterpret_cast<float*>(m.dram + dram.delayScratch);
+    memset(m.dram + dram.delayRings, 0, dram.total - dram.delayRings);
     
     int p = 0;
     
@@ -232,45 +921,71 @@ static _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& m,
     setParamEnum(self->params[p++], "Bypass", 0, 1, 0, offOnStrings);
     // 0..10 fade amount (0 = hard switch, 10 = max fade)
     setParam(self->params[p++], "Global Fade", 0, 10, 0, kNT_unitNone);
+    // Soft clip of destination busses after all groups have been added
+    setParamEnum(self->params[p++], "Output Clip", 0, CLIP_COUNT - 1, CLIP_OFF, clipStrings);
+    setParam(self->params[p++], "Clip Level", 10, 100, 100, kNT_unitVolts);
+    self->params[p - 1].scaling = kNT_scaling10;
+    // Governor: trade smoothness for CPU when step() exceeds this share of a block
+    setParam(self->params[p++], "CPU Budget", 0, 100, 0, kNT_unitPercent);
+    // How often the Volume/Pan/Fade CV inputs are read
+    setParam(self->params[p++], "CV Rate", 10, 1000, 500, kNT_unitHz);
+    
+    // Global MIDI: one channel for all groups, group g on CC base + g
+    if (sp[SPEC_GLOBAL_MIDI]) {
+        setParamEnum(self->params[p++], "MIDI Enable", 0, 1, 0, offOnStrings);
+        setParam(self->params[p++], "MIDI Channel", 1, 16, 1, kNT_unitNone);
+        setParam(self->params[p++], "MIDI Base CC", 0, 127, 0, kNT_unitNone);
+    }
     
     // Destination name arrays
     static const char* destLNames[] = { "Dest 1 L", "Dest 2 L", "Dest 3 L", "Dest 4 L" };
     static const char* destRNames[] = { "Dest 1 R", "Dest 2 R", "Dest 3 R", "Dest 4 R" };
+    static const char* inputLNames[] = { "Input 2 L", "Input 3 L", "Input 4 L" };
+    static const char* inputRNames[] = { "Input 2 R", "Input 3 R", "Input 4 R" };
+    static const char* inputLevelNames[] = { "Input 2 Level", "Input 3 Level", "Input 4 Level" };
+    static const char* destDelayNames[] = { "Dest 1 Delay", "Dest 2 Delay", "Dest 3 Delay", "Dest 4 Delay" };
+    static const char* zoneStartNames[] = { "Zone 2 Start", "Zone 3 Start", "Zone 4 Start" };
     
     // --- Per-group parameters ---
+    // Defined by GroupParamOffset, then packed: groupLayout() alone decides
+    // which of them a group has
+    _NT_parameter def[PARAMS_PER_GROUP_MAX] = {};
     for (int g = 0; g < groups; ++g) {
         // Single input (mono or stereo) – all groups default to In 1/2
-        setParam(self->params[p++], "Input L", 0, MAX_BUSSES,
+        setParam(def[GP_INPUT_L], "Input L", 0, MAX_BUSSES,
                  1, kNT_unitAudioInput);
-        setParam(self->params[p++], "Input R", 0, MAX_BUSSES,
+        setParam(def[GP_INPUT_R], "Input R", 0, MAX_BUSSES,
                  2, kNT_unitAudioInput);  // 0 = mono mode; 2 = default stereo R
         
         // Control input (default 0 = none, use Active Dest param)
-        setParam(self->params[p++], "Control", 0, MAX_BUSSES,
+        setParam(def[GP_CONTROL], "Control", 0, MAX_BUSSES,
                  0, kNT_unitCvInput);
         
         // Volume: 0 = off, 100 = 0dB, 106 = +6dB
-        setParam(self->params[p++], "Volume", 0, 106, 100, kNT_unitNone);
+        setParam(def[GP_VOLUME], "Volume", 0, 106, 100, kNT_unitNone);
         
         // Pan: -50..50 (center=0)
-        setParam(self->params[p++], "Pan", -50, 50, 0, kNT_unitPercent);
+        setParam(def[GP_PAN], "Pan", -50, 50, 0, kNT_unitPercent);
         
-        // Control type
-        setParamEnum(self->params[p++], "Ctrl Type", 0, CTRL_TYPE_COUNT - 1,
+        // Control type (the Env types come with the Envelope spec)
+        setParamEnum(def[GP_CTRL_TYPE], "Ctrl Type", 0,
+                     sp[SPEC_ENVELOPE] ? CTRL_TYPE_COUNT - 1 : CTRL_ENV - 1,
                      CTRL_UNIPOLAR, controlTypeStrings);
         
-        // Curve (reserved for future more complex curves)
-        setParamEnum(self->params[p++], "Curve", 0, CURVE_COUNT - 1,
+        // Curve: Adaptive shapes the fade for the destinations' correlation
+        // (with its Correlation param, in the Fade Options spec)
+        setParamEnum(def[GP_CURVE], "Curve", 0,
+                     sp[SPEC_FADE_OPTIONS] ? CURVE_COUNT - 1 : CURVE_ADAPTIVE - 1,
                      CURVE_EQUAL_POWER, curveStrings);
         
         // Fade amount (per group) 0..10
-        setParam(self->params[p++], "Fade", 0, 10, 0, kNT_unitNone);
+        setParam(def[GP_FADE_TIME], "Fade", 0, 10, 0, kNT_unitNone);
         
         // Destination crossfade on/off
-        setParamEnum(self->params[p++], "Dest Xfade", 0, 1, 1, offOnStrings);
+        setParamEnum(def[GP_DEST_XFADE], "Dest Xfade", 0, 1, 1, offOnStrings);
         
         // Active Destination (1 to numDests) - THIS IS MAPPABLE TO I2C!
-        setParam(self->params[p++], "Active Dest", 1, dests, 1, kNT_unitNone);
+        setParam(def[GP_ACTIVE_DEST], "Active Dest", 1, dests, 1, kNT_unitNone);
         
         // Destination pairs (only as many as specified)
         for (int d = 0; d < dests; ++d) {
@@ -278,38 +993,125 @@ static _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& m,
             int outL = 1 + (d * 2); // 1,3,5,7
             int outR = 2 + (d * 2); // 2,4,6,8
             
-            setParam(self->params[p++], destLNames[d], 0, MAX_BUSSES, outL, kNT_unitAudioOutput);
-            setParam(self->params[p++], destRNames[d], 0, MAX_BUSSES, outR, kNT_unitAudioOutput);
+            setParam(def[GP_DEST1_L + d * 2], destLNames[d], 0, MAX_BUSSES, outL, kNT_unitAudioOutput);
+            setParam(def[GP_DEST1_R + d * 2], destRNames[d], 0, MAX_BUSSES, outR, kNT_unitAudioOutput);
         }
         
-        // MIDI
-        setParamEnum(self->params[p++], "MIDI Enable", 0, 1, 0, offOnStrings);
-        setParam(self->params[p++], "MIDI Channel", 1, 16, 1, kNT_unitNone);
-        setParam(self->params[p++], "MIDI CC", 0, 127, g, kNT_unitNone);
+        // MIDI (on the Global page with the Global MIDI spec)
+        setParamEnum(def[GP_MIDI_ENABLE], "MIDI Enable", 0, 1, 0, offOnStrings);
+        setParam(def[GP_MIDI_CHANNEL], "MIDI Channel", 1, 16, 1, kNT_unitNone);
+        setParam(def[GP_MIDI_CC], "MIDI CC", 0, 127, g, kNT_unitNone);
+        
+        // Gesture recorder/looper
+        setParamEnum(def[GP_GESTURE], "Gesture", 0, GESTURE_MODE_COUNT - 1,
+                     GESTURE_OFF, gestureStrings);
+        
+        // Follow Group: only earlier groups can lead, so group 1 is always Off
+        setParamEnum(def[GP_FOLLOW], "Follow Group", 0, g, 0, followStrings);
+        
+        // Extra input pairs summed into the route (0 = unused)
+        for (int i = 1; i < inputs; ++i) {
+            setParam(def[GP_INPUT2_L + (i - 1) * 3], inputLNames[i - 1], 0, MAX_BUSSES, 0, kNT_unitAudioInput);
+            setParam(def[GP_INPUT2_R + (i - 1) * 3], inputRNames[i - 1], 0, MAX_BUSSES, 0, kNT_unitAudioInput);
+            // Level: 0 = off, 100 = 0dB, 106 = +6dB
+            setParam(def[GP_INPUT2_LEVEL + (i - 1) * 3], inputLevelNames[i - 1], 0, 106, 100, kNT_unitNone);
+        }
+        
+        // Priority ducking: a group ducks lower-priority groups sharing its active dest
+        setParam(def[GP_PRIORITY], "Priority", 0, MAX_PRIORITY, 0, kNT_unitNone);
+        setParam(def[GP_DUCK], "Duck", 0, MAX_DUCK_DB, 0, kNT_unitDb);
+        
+        // Envelope follower for the Env control types
+        setParam(def[GP_ENV_THRESHOLD], "Env Threshold", -60, 0, -20, kNT_unitDb);
+        setParam(def[GP_ENV_ATTACK], "Env Attack", 0, 1000, 5, kNT_unitMs);
+        setParam(def[GP_ENV_RELEASE], "Env Release", 1, 5000, 200, kNT_unitMs);
+        setParam(def[GP_ENV_HOLD], "Env Hold", 0, 5000, 100, kNT_unitMs);
+        
+        // Internal modulation source: 0.01..20 Hz, or one cycle per clock
+        setParamEnum(def[GP_MOD_SOURCE], "Mod Source", 0, MOD_SOURCE_COUNT - 1,
+                     MOD_OFF, modSourceStrings);
+        setParam(def[GP_MOD_RATE], "Mod Rate", 1, 2000, 100, kNT_unitHz);
+        def[GP_MOD_RATE].scaling = kNT_scaling100;
+        setParam(def[GP_MOD_CLOCK], "Mod Clock", 0, MAX_BUSSES, 0, kNT_unitCvInput);
+        
+        // Which of Control, MIDI and Active Dest decides the destination
+        setParamEnum(def[GP_ARBITRATION], "Arbitration", 0, ARB_MODE_COUNT - 1,
+                     ARB_LAST_TOUCHED, arbitrationStrings);
+        
+        // Custom control zones: where each destination's zone starts, in volts
+        // (defaults split 0-10V evenly)
+        setParamEnum(def[GP_ZONES], "Zones", 0, ZONE_MODE_COUNT - 1,
+                     ZONES_EQUAL, zoneModeStrings);
+        for (int d = 1; d < dests; ++d) {
+            // Absolute volts: the defaults split the Unipolar 0-10 V range evenly;
+            // Bipolar needs them re-entered across -5..5 V
+            setParam(def[GP_ZONE2_START + d - 1], zoneStartNames[d - 1], -50, 100,
+                     (int16_t)(100 * d / dests), kNT_unitVolts);
+            def[GP_ZONE2_START + d - 1].scaling = kNT_scaling10;
+        }
+        
+        // Aux send: always-on copy of the group to e.g. a reverb bus
+        setParam(def[GP_AUX_L], "Aux L", 0, MAX_BUSSES, 0, kNT_unitAudioOutput);
+        setParam(def[GP_AUX_R], "Aux R", 0, MAX_BUSSES, 0, kNT_unitAudioOutput);
+        setParam(def[GP_AUX_LEVEL], "Aux Level", 0, 106, 100, kNT_unitNone);
+        setParamEnum(def[GP_AUX_TAP], "Aux Tap", 0, AUX_TAP_COUNT - 1, AUX_PRE, auxTapStrings);
+        
+        // Mid/Side: the mid follows the group's control, the side has its own destination
+        setParamEnum(def[GP_ROUTING], "Routing", 0, ROUTING_MODE_COUNT - 1,
+                     ROUTING_NORMAL, routingStrings);
+        setParam(def[GP_SIDE_DEST], "Side Dest", 1, dests, 2, kNT_unitNone);
+        
+        // Adaptive curve: 0% = constant power, 100% = linear
+        setParam(def[GP_CORRELATION], "Correlation", 0, 100, 0, kNT_unitPercent);
+        
+        // Modulation CV: Volume 0-10V scales the output, Pan +-5V offsets it
+        // by +-100%, Fade adds 1 step per volt
+        setParam(def[GP_VOLUME_CV], "Volume CV", 0, MAX_BUSSES, 0, kNT_unitCvInput);
+        setParam(def[GP_PAN_CV], "Pan CV", 0, MAX_BUSSES, 0, kNT_unitCvInput);
+        setParam(def[GP_FADE_CV], "Fade CV", 0, MAX_BUSSES, 0, kNT_unitCvInput);
+        
+        // Fade-out amount when it should differ from Fade (0 = same)
+        setParam(def[GP_FADE_OUT], "Fade Out", 0, 10, 0, kNT_unitNone);
+        
+        // New target mid-fade: bounded policies keep at most 2 destinations open
+        setParamEnum(def[GP_RETRIGGER], "Retrigger", 0, RETRIGGER_POLICY_COUNT - 1,
+                     RETRIG_CHASE, retriggerStrings);
+        
+        self->groupState[g].mod.seed += 0x6D2B79F5u * g;  // Decorrelate random steps
+        self->midiKey[g] = -1;
+        
+        // Latency compensation per destination, in samples
+        for (int d = 0; d < dests; ++d) {
+            setParam(def[GP_DEST1_DELAY + d], destDelayNames[d], 0,
+                     (int16_t)std::min<uint32_t>(self->maxDelay, 32767), 0, kNT_unitNone);
+        }
+        
+        for (int gp = 0; gp < PARAMS_PER_GROUP_MAX; ++gp) {
+            if (self->gpOffset[gp] >= 0) {
+                self->params[p + self->gpOffset[gp]] = def[gp];
+            }
+        }
+        p += self->paramsPerGroup;
     }
     
     // Set the parameters pointer for the base _NT_algorithm struct
     self->parameters = self->params;
     
-    // Setup parameter pages
-    // Page 0: Global parameters
-    for (uint8_t i = 0; i < GLOBAL_PARAM_COUNT; ++i) {
-        self->globalParamIndices[i] = i;
+    // Setup parameter pages: every page is a run of consecutive parameters
+    for (int i = 0; i < p; ++i) {
+        self->pageIndices[i] = (uint8_t)i;
     }
+    // Page 0: Global parameters
     self->pageDefs[0].name      = "Global";
-    self->pageDefs[0].numParams = GLOBAL_PARAM_COUNT;
-    self->pageDefs[0].params    = self->globalParamIndices;
+    self->pageDefs[0].numParams = self->numGlobals;
+    self->pageDefs[0].params    = self->pageIndices;
     
     // Pages 1-N: One per group
     static const char* groupNames[MAX_GROUPS] = { "Group 1", "Group 2", "Group 3", "Group 4" };
     for (int g = 0; g < groups; ++g) {
-        const int baseIdx = GLOBAL_PARAM_COUNT + (g * self->paramsPerGroup);
-        for (uint8_t i = 0; i < self->paramsPerGroup; ++i) {
-            self->groupParamIndices[g][i] = baseIdx + i;
-        }
         self->pageDefs[g + 1].name      = groupNames[g];
         self->pageDefs[g + 1].numParams = self->paramsPerGroup;
-        self->pageDefs[g + 1].params    = self->groupParamIndices[g];
+        self->pageDefs[g + 1].params    = self->pageIndices + groupBase(self, g);
     }
     
     // Set up the pages structure
@@ -321,19 +1123,36 @@ static _NT_algorithm* construct(const _NT_algorithmMemoryPtrs& m,
 }
 
 /* ───── control processing ───── */
-// Returns target destination index (0 to numDests-1)
-static int processControl(float cv, ControlType type, int numDests, MixerGroupState& state) {
-    int dest = state.targetDest;
+// Custom zones: one table read for a voltage above the bottom of the range
+static inline int zoneLookup(const uint8_t* zones, float fromBottom) {
+    const float cell = fromBottom * (ZONE_LUT_SIZE / ZONE_RANGE_VOLTS);
+    return zones[smxClamp((int)cell, 0, ZONE_LUT_SIZE - 1)];
+}
+
+// Returns the destination index (0 to numDests-1) the control selects, or -1
+// if it selects nothing new. Triggers step onward from `from`. With custom
+// zones, `zones` is the group's compiled lookup table.
+static int processControl(float cv, ControlType type, int numDests, int from,
+                          const uint8_t* zones, MixerGroupState& state) {
+    int dest = -1;
     
     switch (type) {
         case CTRL_UNIPOLAR: {
             // 0V = Dest 1, 10V = Dest N
+            if (zones) {
+                dest = zoneLookup(zones, cv);
+                break;
+            }
             float normalized = smxClamp(cv / 10.0f, 0.0f, 0.9999f);
             dest = (int)(normalized * numDests);
             break;
         }
         case CTRL_BIPOLAR: {
             // -5V = Dest 1, +5V = Dest N
+            if (zones) {
+                dest = zoneLookup(zones, cv + 5.0f);
+                break;
+            }
             float normalized = smxClamp((cv + 5.0f) / 10.0f, 0.0f, 0.9999f);
             dest = (int)(normalized * numDests);
             break;
@@ -342,7 +1161,7 @@ static int processControl(float cv, ControlType type, int numDests, MixerGroupSt
             // Rising edge advances to next destination
             bool high = cv > TRIGGER_THRESHOLD;
             if (high && !state.lastTriggerHigh) {
-                dest = (state.targetDest + 1) % numDests;
+                dest = (from + 1) % numDests;
             }
             state.lastTriggerHigh = high;
             break;
@@ -351,7 +1170,7 @@ static int processControl(float cv, ControlType type, int numDests, MixerGroupSt
             // Rising edge goes to previous destination
             bool high = cv > TRIGGER_THRESHOLD;
             if (high && !state.lastTriggerHigh) {
-                dest = (state.targetDest + numDests - 1) % numDests;
+                dest = (from + numDests - 1) % numDests;
             }
             state.lastTriggerHigh = high;
             break;
@@ -368,221 +1187,1432 @@ static int processControl(float cv, ControlType type, int numDests, MixerGroupSt
             break;
     }
     
-    return smxClamp(dest, 0, numDests - 1);
+    return (dest < 0) ? -1 : smxClamp(dest, 0, numDests - 1);
 }
 
-/* ───── DSP step ───── */
-static void step(_NT_algorithm* b, float* buf, int nBy4) {
-    SwitchingMixer* self = static_cast<SwitchingMixer*>(b);
-    const int N = nBy4 * 4;
-    
-    if (self->v[PARAM_BYPASS]) {
+// Env control: decides the destination from the peak follower, holding
+// "above" for the hold time after the level drops. Runs once per block.
+static int envelopeControl(float threshold, int holdSamples, ControlType type,
+                           int numDests, int N, MixerGroupState& state) {
+    bool above = state.env >= threshold;
+    if (above) {
+        state.envHold = holdSamples;
+    } else if (state.envHold > 0) {
+        state.envHold -= N;
+        above = true;
+    }
+    const int high = std::min(1, numDests - 1);
+    if (type == CTRL_ENV_REV) {
+        return above ? 0 : high;
+    }
+    return above ? high : 0;
+}
+
+/* ───── source arbitration ───── */
+static inline bool isEdgeControl(ControlType type) {
+    return type == CTRL_TRIGGER || type == CTRL_TRIG_REV;
+}
+
+// Where a trigger from `src` steps from: the live target when the last
+// touch wins, otherwise the source's own position
+static inline int arbFrom(const MixerGroupState& state, ControlSource src, ArbitrationMode mode) {
+    return (mode == ARB_LAST_TOUCHED) ? state.targetDest : state.srcDest[src];
+}
+
+// Records a destination from one source. Level-type sources only count as a
+// touch when their destination moves; edges (triggers) always do.
+static inline void arbSource(MixerGroupState& state, ControlSource src, int dest, bool edge) {
+    const uint8_t bit = (uint8_t)(1u << src);
+    if (!edge && (state.srcValid & bit) && state.srcDest[src] == dest) {
         return;
     }
-    
-    // Global fade amount 0..10
-    const float globalFadeAmt = (float)self->v[PARAM_GLOBAL_SLEW];
-    const float sampleRate    = getSampleRateFloat();
-    const int   numDests      = self->numDests;
-    const int   paramsPerGroup = self->paramsPerGroup;
-    
-    for (int g = 0; g < self->numGroups; ++g) {
-        const int base = GLOBAL_PARAM_COUNT + (g * paramsPerGroup);
-        MixerGroupState& state = self->groupState[g];
-        
-        // Get parameters (fixed indices)
-        const int inputL    = self->v[base + GP_INPUT_L];
-        const int inputR    = self->v[base + GP_INPUT_R];
-        const int controlBus = self->v[base + GP_CONTROL];
+    state.srcDest[src] = (int8_t)dest;
+    state.srcValid    |= bit;
+    state.lastTouched  = (uint8_t)src;
+    if (src != SRC_CONTROL) {
+        state.lastManual = (uint8_t)src;
+    }
+    state.arbPending = true;
+}
 
-        // Volume 0..106 (0=off, 100=0dB, 106=+6dB)
-        const int volRaw = self->v[base + GP_VOLUME];
-        float volume;
-        if (volRaw <= 0) {
-            volume = 0.0f;
-        } else {
-            float db = (float)volRaw - 100.0f;
-            volume = dbToGain(db);
-        }
+static inline void arbDrop(MixerGroupState& state, ControlSource src) {
+    const uint8_t bit = (uint8_t)(1u << src);
+    if (state.srcValid & bit) {
+        state.srcValid  &= (uint8_t)~bit;
+        state.arbPending = true;
+    }
+}
 
-        // Pan -50..50 -> -1..1
-        const int panRaw = self->v[base + GP_PAN];
-        float panNorm = smxClamp(panRaw / 50.0f, -1.0f, 1.0f);
-        const float angle = (panNorm + 1.0f) * 0.25f * 3.14159265f;
-        const float panGL = std::cos(angle);
-        const float panGR = std::sin(angle);
+// A recorded source index if it still holds a destination, else `fallback`
+static inline int arbValid(uint8_t valid, uint8_t src, int fallback) {
+    return (src < SRC_COUNT && (valid & (1u << src))) ? (int)src : fallback;
+}
 
-        const ControlType ctrlType = (ControlType)smxClamp(
-            (int)self->v[base + GP_CTRL_TYPE], 0, (int)CTRL_TYPE_COUNT - 1);
-        const CrossfadeCurve curve = (CrossfadeCurve)smxClamp(
-            (int)self->v[base + GP_CURVE], 0, (int)CURVE_COUNT - 1);
-        (void)curve; // reserved
-        
-        const float fadeAmtLocal = (float)self->v[base + GP_FADE_TIME]; // 0..10
-        const int destXfade = self->v[base + GP_DEST_XFADE] ? 1 : 0;
-        
-        // Active Dest parameter (1-based, convert to 0-based)
-        const int activeDestParam = smxClamp((int)self->v[base + GP_ACTIVE_DEST], 1, numDests) - 1;
-        
-        // Get input bus pointers
-        float* inL  = bus(buf, inputL, N);
-        float* inR  = bus(buf, inputR, N);
-        float* ctrl = bus(buf, controlBus, N);
-        
-        // Get destination bus pointers (dynamic based on numDests)
-        float* destL[MAX_DESTINATIONS];
-        float* destR[MAX_DESTINATIONS];
-        for (int d = 0; d < numDests; ++d) {
-            destL[d] = bus(buf, self->v[base + GP_DEST1_L + d * 2], N);
-            destR[d] = bus(buf, self->v[base + GP_DEST1_R + d * 2], N);
-        }
-        
-        // Determine target destination
-        if (ctrl) {
-            state.targetDest = processControl(ctrl[N - 1], ctrlType, numDests, state);
-        } else {
-            state.targetDest = activeDestParam;
-        }
-        
-        // Update target gains
-        for (int d = 0; d < numDests; ++d) {
-            state.targetGains[d] = (d == state.targetDest) ? 1.0f : 0.0f;
+// Resolves the group's target from its sources. Only runs after a source
+// changed, so steady-state blocks leave the target gains alone.
+static void arbitrate(MixerGroupState& state, ArbitrationMode mode, int numDests) {
+    const uint8_t valid = state.srcValid;
+    const int firstValid = (valid & (1u << SRC_CONTROL)) ? SRC_CONTROL
+                         : (valid & (1u << SRC_MIDI))    ? SRC_MIDI : SRC_PARAM;
+    int dest;
+    switch (mode) {
+        case ARB_PRIORITY:
+            dest = state.srcDest[firstValid];
+            break;
+        case ARB_OFFSET: {
+            const int manual = arbValid(valid, state.lastManual, (int)SRC_PARAM);
+            const int offset = (valid & (1u << SRC_CONTROL)) ? state.srcDest[SRC_CONTROL] : 0;
+            dest = (state.srcDest[manual] + offset) % numDests;
+            break;
         }
+        default:
+            dest = state.srcDest[arbValid(valid, state.lastTouched, firstValid)];
+            break;
+    }
+    state.arbPending = false;
+    setTargetDest(state, smxClamp(dest, 0, numDests - 1), numDests);
+}
 
-        // Effective fade amount: per-group overrides global if >0
-        float fadeAmt = (fadeAmtLocal > 0.0f) ? fadeAmtLocal : globalFadeAmt;
+/* ───── internal modulation ───── */
+static inline float modRandom(ModState& ms) {
+    ms.seed ^= ms.seed << 13;
+    ms.seed ^= ms.seed >> 17;
+    ms.seed ^= ms.seed << 5;
+    return (ms.seed >> 8) * (1.0f / 16777216.0f);
+}
 
-        float slewRate;
-        if (!destXfade || fadeAmt <= 0.0f) {
-            // 0 = off -> hard switch
-            slewRate = 1.0f;
-        } else {
-            // Map 1..10 to ~0.1s..5s fade times
-            const float maxFadeSec  = 5.0f;
-            const float fadeTimeSec = (fadeAmt / 10.0f) * maxFadeSec;
-            slewRate = 1.0f - std::exp(-1.0f / (sampleRate * fadeTimeSec));
+// Advances the modulation source by one block (control rate) and returns its
+// position 0..1. With a clock, one cycle spans the measured clock period.
+static float modAdvance(ModState& ms, ModSource src, float rateHz,
+                        const float* clock, int N, float sampleRate) {
+    bool wrapped = false;
+    if (clock) {
+        const bool high = clock[N - 1] > MOD_CLOCK_THRESHOLD;
+        ms.sinceEdge += N;
+        if (high && !ms.lastClockHigh) {
+            ms.period    = ms.sinceEdge;
+            ms.sinceEdge = 0;
+            wrapped      = true;
         }
+        ms.lastClockHigh = high;
+        ms.phase = (ms.period > 0)
+            ? std::min((float)ms.sinceEdge / (float)ms.period, 0.9999f)
+            : 0.0f;
+    } else {
+        ms.phase += rateHz * (float)N / sampleRate;
+        if (ms.phase >= 1.0f) {
+            ms.phase -= (float)(int)ms.phase;
+            wrapped = true;
+        }
+    }
+    if (wrapped) {
+        ms.held = modRandom(ms);
+    }
+    
+    switch (src) {
+        case MOD_SINE:   return 0.5f - 0.5f * std::cos(2.0f * 3.14159265f * ms.phase);
+        case MOD_TRI:    return 1.0f - std::fabs(2.0f * ms.phase - 1.0f);
+        case MOD_SAW:    return ms.phase;
+        case MOD_RANDOM: return ms.held;
+        default:         return 0.0f;
+    }
+}
 
-        // Process audio
-        for (int n = 0; n < N; ++n) {
-            // Get raw input samples
-            float inSampleL = inL ? inL[n] : 0.0f;
-            float inSampleR = inR ? inR[n] : inSampleL;  // if no R, duplicate L
-
-            // Treat the input pair as a single mono source
-            float mono = 0.5f * (inSampleL + inSampleR);
+/* ───── gesture recorder ───── */
+static inline uint32_t gestureDelta(uint32_t ev) { return ev >> GESTURE_DEST_BITS; }
+static inline uint8_t  gestureDest(uint32_t ev)  { return (uint8_t)(ev & GESTURE_DEST_MASK); }
 
-            // Apply volume
-            mono *= volume;
+static void gestureAppend(GestureState& gs, uint32_t at, uint8_t dest) {
+    uint32_t delta = at - gs.lastAt;
+    // Split gaps too long for one event into repeats of the current dest
+    while (delta > GESTURE_MAX_DELTA && gs.count < GESTURE_MAX_EVENTS) {
+        gs.events[gs.count++] = (GESTURE_MAX_DELTA << GESTURE_DEST_BITS) | gs.dest;
+        delta -= GESTURE_MAX_DELTA;
+    }
+    if (gs.count >= GESTURE_MAX_EVENTS) {
+        return;  // Buffer full: keep looping what we have
+    }
+    gs.events[gs.count++] = (delta << GESTURE_DEST_BITS) | dest;
+    gs.lastAt = at;
+    gs.dest   = dest;
+}
 
-            // Apply pan to create L/R
-            float sigL = mono * panGL;
-            float sigR = mono * panGR;
-            
-            // Slew the destination gains (or snap if slewRate == 1)
+// Handles Off/Record/Play transitions; called once per block
+static void gestureSetMode(GestureState& gs, int mode, int currentDest) {
+    if (mode == gs.mode) {
+        return;
+    }
+    if (gs.mode == GESTURE_RECORD) {
+        // Closing a take fixes the loop length
+        gs.length = gs.pos;
+        if (gs.length == 0) {
+            gs.count = 0;
+        }
+    }
+    if (mode == GESTURE_RECORD) {
+        gs.count  = 0;
+        gs.pos    = 0;
+        gs.lastAt = 0;
+        gestureAppend(gs, 0, (uint8_t)currentDest);
+    } else if (mode == GESTURE_PLAY) {
+        gs.pos    = 0;
+        gs.cursor = 0;
+        gs.nextAt = (gs.count > 0) ? gestureDelta(gs.events[0]) : 0;
+    }
+    gs.mode = (uint8_t)mode;
+}
+
+static inline bool gesturePlaying(const GestureState& gs) {
+    return gs.mode == GESTURE_PLAY && gs.count > 0 && gs.length > 0;
+}
+
+// Applies every event due at the current position, wrapping at the loop end
+static void gestureApplyDue(GestureState& gs) {
+    while (gs.pos >= gs.nextAt) {
+        if (gs.cursor == gs.count) {
+            gs.pos   -= gs.length;
+            gs.cursor = 0;
+            gs.nextAt = gestureDelta(gs.events[0]);
+            continue;
+        }
+        gs.dest = gestureDest(gs.events[gs.cursor++]);
+        gs.nextAt = (gs.cursor < gs.count)
+            ? gs.nextAt + gestureDelta(gs.events[gs.cursor])
+            : gs.length;
+    }
+}
+
+/* ───── mixing ───── */
+// Per-block routing for one group
+struct GroupRoute {
+    const float* inL[MAX_INPUTS];
+    const float* inR[MAX_INPUTS];
+    float inGain[MAX_INPUTS];  // Per-input level * volume * 0.5 (mono sum)
+    int   numInputs;
+    float* destL[MAX_DESTINATIONS];
+    float* destR[MAX_DESTINATIONS];
+    int   numDests;
+    float panGL;
+    float panGR;
+    float panGLInc;    // Volume/Pan CV ramp per sample (0 without CV)
+    float panGRInc;
+    float slewRate;    // Fade-in coefficient
+    float fallRate;    // Fade-out coefficient
+    float killRate;    // Coefficient of destinations in the state's killMask
+    float killDecay;   // (1 - killRate)^killFrames, for the governed path
+    int   killFrames;
+    float duck[MAX_DESTINATIONS];     // Ducking gain at sample 0
+    float duckInc[MAX_DESTINATIONS];  // Ducking ramp per sample
+    bool  detect;      // Env control: run the peak follower in the mix loop
+    float envAttack;   // Peak follower attack coefficient
+    float envRelease;  // Peak follower release multiplier
+    float* gainOut;    // Leader with followers: per-sample gains, else nullptr
+    int   gainStride;  // Floats between destinations in a gain buffer
+    uint8_t quality;   // GovernorLevel
+    float* auxL;       // Aux send busses (both nullptr = no send)
+    float* auxR;
+    float  auxGain;
+    bool   auxPost;    // Scale the send by the routed gain
+    bool   midSide;    // Leader in Mid/Side routing
+    bool   shaped;     // Correlation-aware curve: gains via curveGain() per segment
+    float  correlation;
+    float slewDecay;   // (1 - slewRate)^slewFrames, for the governed path
+    float fallDecay;   // (1 - fallRate)^slewFrames
+    int   slewFrames;
+};
+
+// Slew coefficient per destination for one segment. Targets are one-hot and
+// only change between segments, so a destination whose target is open rises,
+// killed ones close fast and the rest fall; the choice is made here rather
+// than per sample.
+static inline void segmentRates(const GroupRoute& r, const float* targetGains, uint32_t killMask,
+                                float* rate) {
+    for (int d = 0; d < r.numDests; ++d) {
+        rate[d] = (killMask & (1u << d)) ? r.killRate
+                : (targetGains[d] > 0.0f) ? r.slewRate : r.fallRate;
+    }
+}
+
+// Sums one frame of the group's input pairs and applies volume and pan.
+// Returns the mono signal before pan.
+static inline float groupSample(const GroupRoute& r, int n, float& sigL, float& sigR) {
+    float mono = 0.0f;
+    for (int i = 0; i < r.numInputs; ++i) {
+        // Get raw input samples
+        float inSampleL = r.inL[i] ? r.inL[i][n] : 0.0f;
+        float inSampleR = r.inR[i] ? r.inR[i][n] : inSampleL;  // if no R, duplicate L
+
+        // Treat each input pair as a single mono source (gain includes volume)
+        mono += r.inGain[i] * (inSampleL + inSampleR);
+    }
+
+    // Apply pan to create L/R
+    sigL = mono * (r.panGL + r.panGLInc * n);
+    sigR = mono * (r.panGR + r.panGRInc * n);
+    return mono;
+}
+
+// Bit in a touched mask for the aux send busses
+constexpr uint32_t AUX_TOUCHED = 1u << MAX_DESTINATIONS;
+
+static inline bool hasAux(const GroupRoute& r) {
+    return (r.auxL || r.auxR) && r.auxGain > 0.0f;
+}
+
+// Adds one frame to the aux send; `routed` is the summed destination gain
+static inline void auxSample(const GroupRoute& r, int n, float sigL, float sigR, float routed) {
+    const float gain = r.auxPost ? r.auxGain * routed : r.auxGain;
+    if (r.auxL) r.auxL[n] += sigL * gain;
+    if (r.auxR) r.auxR[n] += sigR * gain;
+}
+
+// Mixes samples [n0, n1) of one group into its destinations.
+// With Detect, the Env control's peak follower runs in the same pass.
+// Returns a bitmask of the destinations written.
+template <bool Detect>
+static uint32_t mixSegment(MixerGroupState& state, const GroupRoute& r, int n0, int n1) {
+    const int numDests = r.numDests;
+    const bool aux = hasAux(r);
+    uint32_t touched = 0;
+    float env = state.env;
+    float rate[MAX_DESTINATIONS];
+    segmentRates(r, state.targetGains, state.killMask, rate);
+    for (int n = n0; n < n1; ++n) {
+        float sigL, sigR;
+        const float mono = groupSample(r, n, sigL, sigR);
+        
+        if (Detect) {
+            // One-multiply peak follower
+            const float level = std::fabs(mono);
+            env = (level > env) ? env + (level - env) * r.envAttack : env * r.envRelease;
+        }
+        
+        // Slew the destination gains (or snap if the rate is 1)
+        for (int d = 0; d < numDests; ++d) {
+            state.destGains[d] += (state.targetGains[d] - state.destGains[d]) * rate[d];
+        }
+        
+        // Publish the envelope for follower groups
+        if (r.gainOut) {
             for (int d = 0; d < numDests; ++d) {
-                state.destGains[d] += (state.targetGains[d] - state.destGains[d]) * slewRate;
+                r.gainOut[d * r.gainStride + n] = state.destGains[d];
             }
-            
-            // Output to each destination based on its gain
+        }
+        
+        // Output to each destination based on its (ducked) gain
+        float routed = 0.0f;
+        for (int d = 0; d < numDests; ++d) {
+            float gain = state.destGains[d] * (r.duck[d] + r.duckInc[d] * n);
+            if (gain > 0.0001f) {  // Only write if gain is significant
+                if (r.destL[d]) r.destL[d][n] += sigL * gain;
+                if (r.destR[d]) r.destR[d][n] += sigR * gain;
+                touched |= 1u << d;
+                routed += (r.destL[d] || r.destR[d]) ? gain : 0.0f;
+            }
+        }
+        if (aux) {
+            auxSample(r, n, sigL, sigR, routed);
+        }
+    }
+    state.env = env;
+    return aux ? touched | AUX_TOUCHED : touched;
+}
+
+// Governed variant of mixSegment: the slew and peak follower advance once for
+// the whole segment, and each destination's slewed, ducked gain is ramped
+// linearly between the segment's end points (held at the start value when
+// coarse). Destinations silent at both ends cost nothing. Also serves the
+// Adaptive curve, which shapes the end points with curveGain().
+template <bool Detect>
+static uint32_t mixSegmentBlock(MixerGroupState& state, const GroupRoute& r, int n0, int n1,
+                                bool coarse) {
+    const int   numDests = r.numDests;
+    const int   len      = n1 - n0;
+    const float invLen   = 1.0f / (float)len;
+    const float riseDecay = (r.slewRate >= 1.0f) ? 0.0f
+                          : (len == r.slewFrames) ? r.slewDecay
+                          : std::pow(1.0f - r.slewRate, (float)len);
+    const float fallDecay = (r.fallRate == r.slewRate) ? riseDecay
+                          : (r.fallRate >= 1.0f) ? 0.0f
+                          : (len == r.slewFrames) ? r.fallDecay
+                          : std::pow(1.0f - r.fallRate, (float)len);
+    const float killDecay = !state.killMask ? 0.0f
+                          : (len == r.killFrames) ? r.killDecay
+                          : std::pow(1.0f - r.killRate, (float)len);
+    
+    float    gain[MAX_DESTINATIONS];
+    float    gainInc[MAX_DESTINATIONS];
+    float    slewFrom[MAX_DESTINATIONS];
+    float    slewInc[MAX_DESTINATIONS];
+    float    routed    = 0.0f;
+    float    routedInc = 0.0f;
+    uint32_t active = 0;
+    for (int d = 0; d < numDests; ++d) {
+        // Hard switches snap at the segment start, as on the full-quality path
+        const bool  kill  = (state.killMask & (1u << d)) != 0;
+        const bool  rise  = state.targetGains[d] > 0.0f;
+        const float rate  = kill ? r.killRate : rise ? r.slewRate : r.fallRate;
+        const float decay = kill ? killDecay : rise ? riseDecay : fallDecay;
+        const float from = (rate >= 1.0f) ? state.targetGains[d] : state.destGains[d];
+        const float to   = state.targetGains[d] + (from - state.targetGains[d]) * decay;
+        const float sFrom = r.shaped ? curveGain(from, r.correlation) : from;
+        const float sTo   = r.shaped ? curveGain(to, r.correlation) : to;
+        const float g0   = sFrom * (r.duck[d] + r.duckInc[d] * n0);
+        const float g1   = sTo * (r.duck[d] + r.duckInc[d] * n1);
+        slewFrom[d] = sFrom;
+        slewInc[d]  = coarse ? 0.0f : (sTo - sFrom) * invLen;
+        gain[d]     = g0;
+        gainInc[d]  = coarse ? 0.0f : (g1 - g0) * invLen;
+        state.destGains[d] = to;
+        if (std::max(g0, g1) > 0.0001f) {
+            active |= 1u << d;
+        }
+        if (r.destL[d] || r.destR[d]) {
+            routed    += gain[d];
+            routedInc += gainInc[d];
+        }
+    }
+    const bool aux = hasAux(r);
+    
+    // Publish the envelope for follower groups, held like gain[] when coarse
+    // so followers hear exactly what the leader applied
+    if (r.gainOut) {
+        for (int d = 0; d < numDests; ++d) {
+            float* out = r.gainOut + d * r.gainStride;
+            for (int n = n0; n < n1; ++n) {
+                out[n] = slewFrom[d] + slewInc[d] * (n - n0);
+            }
+        }
+    }
+    
+    float peak = 0.0f;
+    for (int n = n0; n < n1; ++n) {
+        float sigL, sigR;
+        const float mono = groupSample(r, n, sigL, sigR);
+        if (Detect) {
+            peak = std::max(peak, std::fabs(mono));
+        }
+        for (int d = 0; d < numDests; ++d) {
+            if (active & (1u << d)) {
+                const float g = gain[d] + gainInc[d] * (n - n0);
+                if (r.destL[d]) r.destL[d][n] += sigL * g;
+                if (r.destR[d]) r.destR[d][n] += sigR * g;
+            }
+        }
+        if (aux) {
+            auxSample(r, n, sigL, sigR, routed + routedInc * (n - n0));
+        }
+    }
+    
+    if (Detect) {
+        // One follower step for the segment's peak
+        state.env = (peak > state.env)
+            ? peak + (state.env - peak) * std::pow(1.0f - r.envAttack, (float)len)
+            : state.env * std::pow(r.envRelease, (float)len);
+    }
+    return aux ? active | AUX_TOUCHED : active;
+}
+
+// Mid/Side variant of mixSegment. The inputs are read once per frame; the mid
+// (the usual mono sum) goes through destGains, and the side, written as +S to
+// L and -S to R so mid and side on one destination decode back to L/R,
+// through sideGains. Both sets slew at the group's rate.
+template <bool Detect>
+static uint32_t mixSegmentMidSide(MixerGroupState& state, const GroupRoute& r, int n0, int n1) {
+    const int numDests = r.numDests;
+    const bool aux = hasAux(r);
+    uint32_t touched = 0;
+    float env = state.env;
+    float rate[MAX_DESTINATIONS];
+    float sideRate[MAX_DESTINATIONS];
+    segmentRates(r, state.targetGains, state.killMask, rate);
+    segmentRates(r, state.sideTargetGains, 0, sideRate);
+    for (int n = n0; n < n1; ++n) {
+        float mid = 0.0f;
+        float side = 0.0f;
+        for (int i = 0; i < r.numInputs; ++i) {
+            const float inL = r.inL[i] ? r.inL[i][n] : 0.0f;
+            const float inR = r.inR[i] ? r.inR[i][n] : inL;
+            mid  += r.inGain[i] * (inL + inR);
+            side += r.inGain[i] * (inL - inR);
+        }
+        const float panL  = r.panGL + r.panGLInc * n;
+        const float panR  = r.panGR + r.panGRInc * n;
+        const float midL  = mid * panL;
+        const float midR  = mid * panR;
+        const float sideL = side * panL;
+        const float sideR = side * panR;
+        
+        if (Detect) {
+            const float level = std::fabs(mid);
+            env = (level > env) ? env + (level - env) * r.envAttack : env * r.envRelease;
+        }
+        
+        for (int d = 0; d < numDests; ++d) {
+            state.destGains[d] += (state.targetGains[d] - state.destGains[d]) * rate[d];
+            state.sideGains[d] += (state.sideTargetGains[d] - state.sideGains[d]) * sideRate[d];
+        }
+        if (r.gainOut) {
             for (int d = 0; d < numDests; ++d) {
-                float gain = state.destGains[d];
-                if (gain > 0.0001f) {  // Only write if gain is significant
-                    if (destL[d]) destL[d][n] += sigL * gain;
-                    if (destR[d]) destR[d][n] += sigR * gain;
-                }
+                r.gainOut[d * r.gainStride + n] = state.destGains[d];
             }
         }
+        
+        float routed = 0.0f;
+        for (int d = 0; d < numDests; ++d) {
+            const float duck  = r.duck[d] + r.duckInc[d] * n;
+            const float gMid  = state.destGains[d] * duck;
+            const float gSide = state.sideGains[d] * duck;
+            if (gMid > 0.0001f || gSide > 0.0001f) {
+                if (r.destL[d]) r.destL[d][n] += midL * gMid + sideL * gSide;
+                if (r.destR[d]) r.destR[d][n] += midR * gMid - sideR * gSide;
+                touched |= 1u << d;
+                routed += (r.destL[d] || r.destR[d]) ? gMid : 0.0f;
+            }
+        }
+        if (aux) {
+            auxSample(r, n, midL + sideL, midR - sideR, routed);
+        }
     }
+    state.env = env;
+    return aux ? touched | AUX_TOUCHED : touched;
 }
 
-/* ───── MIDI handling ───── */
-static void midiMessage(_NT_algorithm* b, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
-    SwitchingMixer* self = static_cast<SwitchingMixer*>(b);
+static inline uint32_t mixGroup(MixerGroupState& state, const GroupRoute& r, int n0, int n1) {
+    if (r.midSide) {
+        // Runs at full quality whatever the governor level
+        return r.detect ? mixSegmentMidSide<true>(state, r, n0, n1)
+                        : mixSegmentMidSide<false>(state, r, n0, n1);
+    }
+    if (r.quality != GOV_FULL || r.shaped) {
+        const bool coarse = (r.quality == GOV_COARSE);
+        return r.detect ? mixSegmentBlock<true>(state, r, n0, n1, coarse)
+                        : mixSegmentBlock<false>(state, r, n0, n1, coarse);
+    }
+    if (r.detect) {
+        return mixSegment<true>(state, r, n0, n1);
+    }
+    return mixSegment<false>(state, r, n0, n1);
+}
 
-    const uint8_t status  = byte0 & 0xF0;
-    const uint8_t channel = (byte0 & 0x0F) + 1;
+// Mixes a whole block of a follower group using its leader's gain envelope.
+// No control decoding or slewing happens here. Returns the dests written.
+static uint32_t mixFollower(const GroupRoute& r, const float* gains, int N) {
+    const int numDests = r.numDests;
+    const bool aux = hasAux(r);
+    uint32_t touched = 0;
+    for (int n = 0; n < N; ++n) {
+        float sigL, sigR;
+        groupSample(r, n, sigL, sigR);
+        
+        float routed = 0.0f;
+        for (int d = 0; d < numDests; ++d) {
+            float gain = gains[d * r.gainStride + n] * (r.duck[d] + r.duckInc[d] * n);
+            if (gain > 0.0001f) {  // Only write if gain is significant
+                if (r.destL[d]) r.destL[d][n] += sigL * gain;
+                if (r.destR[d]) r.destR[d][n] += sigR * gain;
+                touched |= 1u << d;
+                routed += (r.destL[d] || r.destR[d]) ? gain : 0.0f;
+            }
+        }
+        if (aux) {
+            auxSample(r, n, sigL, sigR, routed);
+        }
+    }
+    return aux ? touched | AUX_TOUCHED : touched;
+}
 
-    if (status != 0xB0) return; // CC only
+/* ───── latency compensation ───── */
+// Delayed destinations mix into a zeroed scratch block, which is then pushed
+// through a per-destination ring. Ring copies are block-contiguous (at most
+// two parts), and destinations that are silent with a flushed ring are skipped.
+
+static void ringWrite(float* ring, uint32_t size, uint32_t w, const float* src, int N) {
+    const uint32_t first = std::min<uint32_t>(N, size - w);
+    if (src) {
+        memcpy(ring + w, src, first * sizeof(float));
+        memcpy(ring, src + first, (N - first) * sizeof(float));
+    } else {
+        memset(ring + w, 0, first * sizeof(float));
+        memset(ring, 0, (N - first) * sizeof(float));
+    }
+}
+
+static void ringReadAdd(const float* ring, uint32_t size, uint32_t rd, float* dst, int N) {
+    const uint32_t first = std::min<uint32_t>(N, size - rd);
+    for (uint32_t n = 0; n < first; ++n) {
+        dst[n] += ring[rd + n];
+    }
+    for (uint32_t n = first; n < (uint32_t)N; ++n) {
+        dst[n] += ring[n - first];
+    }
+}
 
-    const int numDests      = self->numDests;
-    const int paramsPerGroup = self->paramsPerGroup;
+static inline float* delayRing(const SwitchingMixer* self, int g, int d) {
+    return self->delayRings + ((g * self->numDests + d) * 2) * self->delayRingSize;
+}
+
+// Swaps delayed destinations for scratch blocks; returns the delayed dest mask.
+// A ring only holds history while it runs: after idling flushed or being
+// bypassed, a new delay would read stale audio, so the ring restarts silent.
+static uint32_t redirectDelays(SwitchingMixer* self, int g, MixerGroupState& state, int base,
+                               GroupRoute& r, int* delays, float** realL, float** realR) {
+    uint32_t mask = 0;
+    for (int d = 0; d < r.numDests; ++d) {
+        delays[d] = smxClamp((int)groupParam(self, base, GP_DEST1_DELAY + d), 0, (int)self->maxDelay);
+        if (delays[d] != state.delayUsed[d]) {
+            if (state.delayUsed[d] == 0 || state.delayTail[d] <= 0) {
+                memset(delayRing(self, g, d), 0, 2 * self->delayRingSize * sizeof(float));
+                state.delayTail[d] = 0;
+            }
+            state.delayUsed[d] = delays[d];
+        }
+        if (delays[d] == 0) {
+            continue;
+        }
+        float* scratch = self->delayScratch + (2 * d) * self->maxFrames;
+        realL[d] = r.destL[d];
+        realR[d] = r.destR[d];
+        r.destL[d] = realL[d] ? scratch : nullptr;
+        r.destR[d] = realR[d] ? scratch + self->maxFrames : nullptr;
+        mask |= 1u << d;
+    }
+    return mask;
+}
+
+// Returns the delayed destinations whose real bus received samples
+static uint32_t applyDelays(SwitchingMixer* self, int g, MixerGroupState& state, uint32_t mask,
+                            uint32_t touched, const int* delays, float** realL, float** realR, int N) {
+    const uint32_t size = self->delayRingSize;
+    uint32_t written = 0;
+    for (int d = 0; d < self->numDests; ++d) {
+        if (!(mask & (1u << d))) {
+            continue;
+        }
+        const bool active = (touched & (1u << d)) != 0;
+        if (!active && state.delayTail[d] <= 0) {
+            continue;  // Idle and flushed: no ring work at all
+        }
+        const uint32_t w  = state.delayWrite[d];
+        const uint32_t rd = (w + size - delays[d]) % size;
+        float* ring    = delayRing(self, g, d);
+        float* scratch = self->delayScratch + (2 * d) * self->maxFrames;
+        float* real[2] = { realL[d], realR[d] };
+        for (int ch = 0; ch < 2; ++ch) {
+            if (!real[ch]) {
+                continue;
+            }
+            float* chRing    = ring + ch * size;
+            float* chScratch = scratch + ch * self->maxFrames;
+            ringWrite(chRing, size, w, active ? chScratch : nullptr, N);
+            ringReadAdd(chRing, size, rd, real[ch], N);
+            if (active) {
+                memset(chScratch, 0, N * sizeof(float));  // Keep scratch zeroed
+            }
+        }
+        state.delayWrite[d] = (w + N) % size;
+        state.delayTail[d]  = active ? delays[d] : state.delayTail[d] - N;
+        written |= 1u << d;
+    }
+    return written;
+}
+
+/* ───── output clipper ───── */
+// Few-FLOP saturators; both are unity gain at 0 and never exceed `level`
+static void clipBus(float* b, int N, OutputClip type, float level) {
+    const float inv = 1.0f / level;
+    if (type == CLIP_CUBIC) {
+        // y = u - 4/27 u^3 on |u| <= 1.5, flat at +-1 beyond
+        for (int n = 0; n < N; ++n) {
+            const float u = smxClamp(b[n] * inv, -1.5f, 1.5f);
+            b[n] = level * u * (1.0f - (4.0f / 27.0f) * u * u);
+        }
+    } else {
+        // tanh(u) ~ u (27 + u^2) / (27 + 9 u^2) on |u| <= 3
+        for (int n = 0; n < N; ++n) {
+            const float u  = smxClamp(b[n] * inv, -3.0f, 3.0f);
+            const float u2 = u * u;
+            b[n] = level * u * (27.0f + u2) / (27.0f + 9.0f * u2);
+        }
+    }
+}
+
+/* ───── priority ducking ───── */
+// Busses a destination writes: its L/R pair, or an array's run of channels
+static uint32_t destBusMask(const SwitchingMixer* self, int base, int d) {
+    const int busL = groupParam(self, base, GP_DEST1_L + d * 2);
+    if (self->numChannels > 1) {
+        uint32_t mask = 0;
+        for (int k = 0; busL > 0 && k < self->numChannels; ++k) {
+            mask |= busBit(busL + k);  // 0 past the last bus, where mixArray stops
+        }
+        return mask;
+    }
+    return busBit(busL) | busBit(groupParam(self, base, GP_DEST1_R + d * 2));
+}
+
+// Computes each group's target duck gain per destination from the routing
+// table: a group active on a bus ducks lower-priority groups routed to it.
+// Runs once per block; uses the targets decided so far.
+static void computeDuckTargets(const SwitchingMixer* self, float target[][MAX_DESTINATIONS]) {
+    const int numGroups = self->numGroups;
+    const int numDests  = self->numDests;
+    int      prio[MAX_GROUPS];
+    uint32_t active[MAX_GROUPS];
     
-    // MIDI params are at end of each group: after dest params
-    // GP_DEST1_L + (numDests * 2) = first MIDI param
-    const int midiEnableOffset  = GP_DEST1_L + (numDests * 2);
-    const int midiChannelOffset = midiEnableOffset + 1;
-    const int midiCCOffset      = midiEnableOffset + 2;
+    for (int g = 0; g < numGroups; ++g) {
+        for (int d = 0; d < numDests; ++d) {
+            target[g][d] = 1.0f;
+        }
+    }
+    if (!self->anyDuck) {
+        return;
+    }
+    
+    for (int g = 0; g < numGroups; ++g) {
+        const int base = groupBase(self, g);
+        const int dest = self->groupState[g].targetDest;
+        prio[g]   = groupParam(self, base, GP_PRIORITY);
+        active[g] = destBusMask(self, base, dest);
+    }
+    
+    for (int g = 0; g < numGroups; ++g) {
+        const int base = groupBase(self, g);
+        for (int d = 0; d < numDests; ++d) {
+            const uint32_t busses = destBusMask(self, base, d);
+            for (int h = 0; h < numGroups; ++h) {
+                const float depth = self->coeffs[h].duckDepth;
+                if (prio[h] <= prio[g] || depth >= target[g][d]) {
+                    continue;
+                }
+                if (busses & active[h]) {
+                    target[g][d] = depth;
+                }
+            }
+        }
+    }
+}
 
-    for (int g = 0; g < self->numGroups; ++g) {
-        const int base = GLOBAL_PARAM_COUNT + (g * paramsPerGroup);
+/* ───── coefficient rebuild ───── */
+// Pan -1..1 to equal-power L/R gains
+static inline void panGains(float panNorm, float& gl, float& gr) {
+    const float angle = (panNorm + 1.0f) * 0.25f * 3.14159265f;
+    gl = std::cos(angle);
+    gr = std::sin(angle);
+}
 
-        if (!self->v[base + midiEnableOffset]) continue;
-        if (channel != self->v[base + midiChannelOffset]) continue;
-        if (byte1  != self->v[base + midiCCOffset])      continue;
+// Per-sample crossfade coefficient for a fade amount 0..10 (1 = hard switch)
+static float fadeSlewRate(bool xfade, float fadeAmt, float sampleRate) {
+    if (!xfade || fadeAmt <= 0.0f) {
+        // 0 = off -> hard switch
+        return 1.0f;
+    }
+    // Map 1..10 to ~0.1s..5s fade times
+    const float maxFadeSec  = 5.0f;
+    const float fadeTimeSec = (fadeAmt / 10.0f) * maxFadeSec;
+    return 1.0f - std::exp(-1.0f / (sampleRate * fadeTimeSec));
+}
 
-        MixerGroupState& state = self->groupState[g];
-        const ControlType ctrlType = (ControlType)smxClamp(
-            (int)self->v[base + GP_CTRL_TYPE], 0, (int)CTRL_TYPE_COUNT - 1);
+static void rebuildGroupCoeffs(SwitchingMixer* self, int g, float sampleRate) {
+    const int base = groupBase(self, g);
+    GroupCoeffs& c = self->coeffs[g];
+    
+    // Volume 0..106 (0=off, 100=0dB, 106=+6dB), folded into each pair's level
+    const float volume = levelToGain(groupParam(self, base, GP_VOLUME));
+    c.inGain[0] = 0.5f * volume;
+    for (int i = 1; i < self->numInputs; ++i) {
+        c.inGain[i] = 0.5f * levelToGain(groupParam(self, base, GP_INPUT2_LEVEL + (i - 1) * 3)) * volume;
+    }
+    
+    // Pan -50..50 -> -1..1
+    c.panNorm = smxClamp(groupParam(self, base, GP_PAN) / 50.0f, -1.0f, 1.0f);
+    panGains(c.panNorm, c.panGL, c.panGR);
+    
+    c.ctrlType = (ControlType)smxClamp(
+        (int)groupParam(self, base, GP_CTRL_TYPE), 0, groupParamMax(self, base, GP_CTRL_TYPE));
+    // Linear, Equal Power and S-Curve are reserved; Adaptive shapes the fade
+    c.curve = (CrossfadeCurve)smxClamp(
+        (int)groupParam(self, base, GP_CURVE), 0, groupParamMax(self, base, GP_CURVE));
+    c.correlation = groupParam(self, base, GP_CORRELATION) * 0.01f;
+    
+    // Effective fade amount: per-group overrides global if >0
+    const float fadeAmtLocal = (float)groupParam(self, base, GP_FADE_TIME);  // 0..10
+    c.fadeAmt    = (fadeAmtLocal > 0.0f) ? fadeAmtLocal : (float)self->v[PARAM_GLOBAL_SLEW];
+    c.xfade      = groupParam(self, base, GP_DEST_XFADE) != 0;
+    c.slewRate   = fadeSlewRate(c.xfade, c.fadeAmt, sampleRate);
+    const float fadeOutLocal = (float)groupParam(self, base, GP_FADE_OUT);  // 0..10
+    c.fadeOutAmt = (fadeOutLocal > 0.0f) ? fadeOutLocal : c.fadeAmt;
+    c.fallRate   = (fadeOutLocal > 0.0f) ? fadeSlewRate(c.xfade, c.fadeOutAmt, sampleRate) : c.slewRate;
+    c.killFrames = 0;
+    c.retrigger  = (RetriggerPolicy)smxClamp(
+        (int)groupParam(self, base, GP_RETRIGGER), 0, (int)RETRIGGER_POLICY_COUNT - 1);
+    c.slewFrames = 0;
+    
+    c.modCv = groupParam(self, base, GP_VOLUME_CV) > 0 || groupParam(self, base, GP_PAN_CV) > 0
+           || groupParam(self, base, GP_FADE_CV) > 0;
+    c.fadeCv = groupParam(self, base, GP_FADE_CV) > 0;
+    if (!c.modCv) {
+        self->groupState[g].cvActive = false;
+    }
+    
+    const int duckDb = smxClamp((int)groupParam(self, base, GP_DUCK), 0, MAX_DUCK_DB);
+    c.duckDepth = (duckDb > 0) ? dbToGain(-(float)duckDb) : 1.0f;
+    
+    // Envelope follower (Env control types)
+    const float attackSec  = groupParam(self, base, GP_ENV_ATTACK) * 0.001f;
+    const float releaseSec = std::max(1, (int)groupParam(self, base, GP_ENV_RELEASE)) * 0.001f;
+    c.envAttack      = (attackSec > 0.0f) ? 1.0f - std::exp(-1.0f / (sampleRate * attackSec)) : 1.0f;
+    c.envRelease     = std::exp(-1.0f / (sampleRate * releaseSec));
+    c.envThreshold   = ENV_REF_VOLTS * dbToGain((float)groupParam(self, base, GP_ENV_THRESHOLD));
+    c.envHoldSamples = (int)(groupParam(self, base, GP_ENV_HOLD) * 0.001f * sampleRate);
+    
+    c.modSource = (ModSource)smxClamp(
+        (int)groupParam(self, base, GP_MOD_SOURCE), 0, (int)MOD_SOURCE_COUNT - 1);
+    c.modRateHz = groupParam(self, base, GP_MOD_RATE) * 0.01f;
+    
+    c.midSide  = groupParam(self, base, GP_ROUTING) == ROUTING_MID_SIDE;
+    c.sideDest = smxClamp((int)groupParam(self, base, GP_SIDE_DEST), 1, (int)self->numDests) - 1;
+    
+    c.auxGain = levelToGain(groupParam(self, base, GP_AUX_LEVEL));
+    c.auxPost = groupParam(self, base, GP_AUX_TAP) == AUX_POST;
+    
+    c.arbMode = (ArbitrationMode)smxClamp(
+        (int)groupParam(self, base, GP_ARBITRATION), 0, (int)ARB_MODE_COUNT - 1);
+    
+    // Custom zones: a destination per 20 mV cell, so control stays one table read
+    c.customZones = groupParam(self, base, GP_ZONES) == ZONES_CUSTOM
+                 && (c.ctrlType == CTRL_UNIPOLAR || c.ctrlType == CTRL_BIPOLAR);
+    if (c.customZones) {
+        // Cell starts and breakpoints in 20 mV units, so 0.1 V steps land exactly
+        const int bottom = (c.ctrlType == CTRL_BIPOLAR) ? -250 : 0;
+        int starts[MAX_DESTINATIONS - 1];
+        for (int d = 1; d < self->numDests; ++d) {
+            starts[d - 1] = groupParam(self, base, GP_ZONE2_START + d - 1) * 5;
+        }
+        for (int i = 0; i < ZONE_LUT_SIZE; ++i) {
+            int dest = 0;
+            for (int d = 1; d < self->numDests; ++d) {
+                dest += (bottom + i >= starts[d - 1]) ? 1 : 0;
+            }
+            c.zoneLut[i] = (uint8_t)dest;
+        }
+    }
+    
+    // Active Dest is a source like any other; moving it is a touch
+    MixerGroupState& state = self->groupState[g];
+    arbSource(state, SRC_PARAM, smxClamp((int)groupParam(self, base, GP_ACTIVE_DEST), 1,
+                                         (int)self->numDests) - 1, false);
+    const bool hasControl = groupParam(self, base, GP_CONTROL) > 0 || c.modSource != MOD_OFF
+                         || c.ctrlType == CTRL_ENV || c.ctrlType == CTRL_ENV_REV;
+    if (!hasControl) {
+        arbDrop(state, SRC_CONTROL);
+    }
+    state.arbPending = true;  // Mode or control type may have changed
+}
+
+// Tables that depend on more than one group or on the global page
+static void rebuildShared(SwitchingMixer* self) {
+    const bool globalMidi = self->numGlobals > GLOBAL_PARAM_COUNT;
+    self->anyDuck = false;
+    for (int g = 0; g < self->numGroups; ++g) {
+        const int base = groupBase(self, g);
         
-        int dest;
+        // Resolve follow chains to their root leader. Groups only follow earlier
+        // groups, so a leader's envelope is always written before it is read.
+        const int follow = smxClamp((int)groupParam(self, base, GP_FOLLOW), 0, g);
+        self->leader[g]       = (int8_t)((follow > 0) ? self->leader[follow - 1] : g);
+        self->hasFollowers[g] = false;
+        if (self->leader[g] != g) {
+            self->hasFollowers[self->leader[g]] = true;
+        }
         
-        switch (ctrlType) {
-            case CTRL_UNIPOLAR:
-            case CTRL_BIPOLAR: {
-                // CC 0-127 maps to destinations
-                float normalized = (byte2 / 127.0f) * 0.9999f;
-                dest = (int)(normalized * numDests);
-                break;
+        self->anyDuck |= self->coeffs[g].duckDepth < 1.0f;
+        
+        self->midiKey[g] = (!globalMidi && groupParam(self, base, GP_MIDI_ENABLE))
+            ? (int16_t)((((groupParam(self, base, GP_MIDI_CHANNEL) - 1) & 0x0F) << 7)
+                        | (groupParam(self, base, GP_MIDI_CC) & 0x7F))
+            : (int16_t)-1;
+        
+        // Disabling MIDI hands the group back to its other sources
+        if (globalMidi ? !self->v[PARAM_MIDI_ENABLE] : self->midiKey[g] < 0) {
+            arbDrop(self->groupState[g], SRC_MIDI);
+        }
+    }
+    
+    self->clipType  = (OutputClip)smxClamp(
+        (int)self->v[PARAM_OUTPUT_CLIP], 0, (int)CLIP_COUNT - 1);
+    self->clipLevel = std::max(1, (int)self->v[PARAM_CLIP_LEVEL]) * 0.1f;
+}
+
+static void updateCoeffs(SwitchingMixer* self, float sampleRate) {
+    for (int g = 0; g < self->numGroups; ++g) {
+        if (self->dirty & (1u << g)) {
+            rebuildGroupCoeffs(self, g, sampleRate);
+        }
+    }
+    if (self->dirty & DIRTY_SHARED) {
+        rebuildShared(self);
+    }
+    self->dirty = 0;
+}
+
+/* ───── modulation CV ───── */
+// On a CV tick, decodes the group's Volume/Pan/Fade CV and sets the output
+// gains ramping to the new values over the ticks' spacing; between ticks the
+// ramp just continues. The gains replace the route's pan gains.
+static void applyModCv(SwitchingMixer* self, MixerGroupState& state, const GroupCoeffs& c,
+                       int base, GroupRoute& route, float* buf, int N, int tickFrames,
+                       bool tick, float sampleRate) {
+    if (tick || !state.cvActive) {
+        const float* volCv  = bus(buf, groupParam(self, base, GP_VOLUME_CV), N);
+        const float* panCv  = bus(buf, groupParam(self, base, GP_PAN_CV), N);
+        const float* fadeCv = bus(buf, groupParam(self, base, GP_FADE_CV), N);
+        
+        const float volume = volCv ? smxClamp(volCv[N - 1] * 0.1f, 0.0f, 1.0f) : 1.0f;
+        float gl = c.panGL;
+        float gr = c.panGR;
+        if (panCv) {
+            panGains(smxClamp(c.panNorm + panCv[N - 1] * 0.2f, -1.0f, 1.0f), gl, gr);
+        }
+        gl *= volume;
+        gr *= volume;
+        if (!state.cvActive) {
+            state.cvGainL  = gl;  // Newly patched: start at the decoded value
+            state.cvGainR  = gr;
+            state.cvActive = true;
+        }
+        state.cvIncL = (gl - state.cvGainL) / (float)tickFrames;
+        state.cvIncR = (gr - state.cvGainR) / (float)tickFrames;
+        state.cvSlewRate = fadeCv
+            ? fadeSlewRate(c.xfade, smxClamp(c.fadeAmt + fadeCv[N - 1], 0.0f, 10.0f), sampleRate)
+            : c.slewRate;
+        state.cvFallRate = !fadeCv ? c.fallRate
+            : (c.fadeOutAmt == c.fadeAmt) ? state.cvSlewRate
+            : fadeSlewRate(c.xfade, smxClamp(c.fadeOutAmt + fadeCv[N - 1], 0.0f, 10.0f), sampleRate);
+    }
+    route.panGL    = state.cvGainL;
+    route.panGR    = state.cvGainR;
+    route.panGLInc = state.cvIncL;
+    route.panGRInc = state.cvIncR;
+    state.cvGainL += state.cvIncL * (float)N;
+    state.cvGainR += state.cvIncR * (float)N;
+}
+
+/* ───── group processing ───── */
+// Queue: true while an outgoing destination is above QUEUE_DONE_GAIN
+static inline bool fadeOpen(const MixerGroupState& state, int numDests) {
+    for (int d = 0; d < numDests; ++d) {
+        if (d != state.targetDest && state.destGains[d] > QUEUE_DONE_GAIN) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decodes control, runs the gesture recorder and mixes one leader group.
+// Returns a bitmask of the destinations written.
+static uint32_t processGroup(SwitchingMixer* self, MixerGroupState& state, GroupRoute& route,
+                             const GroupCoeffs& c, int base, float* buf, int N, float sampleRate) {
+    const int numDests = self->numDests;
+    const ControlType ctrlType = c.ctrlType;
+    const int from = arbFrom(state, SRC_CONTROL, c.arbMode);
+    const uint8_t* zones = c.customZones ? c.zoneLut : nullptr;
+    
+    float* ctrl = bus(buf, groupParam(self, base, GP_CONTROL), N);
+    
+    // Envelope follower (Env control types only)
+    route.detect     = (ctrlType == CTRL_ENV || ctrlType == CTRL_ENV_REV);
+    route.envAttack  = c.envAttack;
+    route.envRelease = c.envRelease;
+    
+    // Decode the control source; the target is only re-resolved on a change
+    int ctrlDest = -1;
+    if (route.detect) {
+        ctrlDest = envelopeControl(c.envThreshold, c.envHoldSamples, ctrlType, numDests, N, state);
+    } else if (c.modSource != MOD_OFF) {
+        // Internal source sweeps the control type's full CV range
+        const float* clock = bus(buf, groupParam(self, base, GP_MOD_CLOCK), N);
+        const float pos    = modAdvance(state.mod, c.modSource, c.modRateHz, clock, N, sampleRate);
+        const float cv     = (ctrlType == CTRL_BIPOLAR) ? pos * 10.0f - 5.0f : pos * 10.0f;
+        ctrlDest = processControl(cv, ctrlType, numDests, from, zones, state);
+    } else if (ctrl) {
+        ctrlDest = processControl(ctrl[N - 1], ctrlType, numDests, from, zones, state);
+    }
+    if (ctrlDest >= 0) {
+        arbSource(state, SRC_CONTROL, ctrlDest, isEdgeControl(ctrlType));
+    }
+
+    // Leaving gesture playback hands the target back to the sources
+    GestureState& gs = state.gesture;
+    const int gestureMode = smxClamp((int)groupParam(self, base, GP_GESTURE), 0,
+                                     (int)GESTURE_MODE_COUNT - 1);
+    if (gestureMode != gs.mode) {
+        state.arbPending = true;
+    }
+    
+    // Retrigger: killed destinations leave the mask once closed, and Queue
+    // holds a new target until the outgoing destinations have faded
+    state.retrigger = c.retrigger;
+    if (state.killMask) {
+        for (int d = 0; d < numDests; ++d) {
+            if (state.destGains[d] <= 0.0001f) {
+                state.killMask &= ~(1u << d);
             }
-            case CTRL_TRIGGER: {
-                bool wasHigh = state.lastMidiValue > 63;
-                bool isHigh  = byte2 > 63;
-                if (isHigh && !wasHigh) {
-                    dest = (state.targetDest + 1) % numDests;
-                } else {
-                    dest = state.targetDest;
-                }
-                break;
+        }
+    }
+    if (state.arbPending && !(c.retrigger == RETRIG_QUEUE && fadeOpen(state, numDests))) {
+        arbitrate(state, c.arbMode, numDests);
+    }
+
+    // Gesture recorder: capture changes, or replay a take
+    gestureSetMode(gs, gestureMode, state.targetDest);
+    if (gs.mode == GESTURE_RECORD) {
+        if (state.targetDest != gs.dest) {
+            gestureAppend(gs, gs.pos, (uint8_t)state.targetDest);
+        }
+        gs.pos += N;
+    }
+
+    route.slewRate   = c.slewRate;
+    route.fallRate   = c.fallRate;
+    route.killRate   = c.killRate;
+    route.killDecay  = c.killDecay;
+    route.killFrames = c.killFrames;
+    route.slewDecay  = c.slewDecay;
+    route.fallDecay  = c.fallDecay;
+    route.slewFrames = c.slewFrames;
+    if (c.fadeCv) {
+        // Fade CV: the block-rate paths compute their own decay
+        route.slewRate   = state.cvSlewRate;
+        route.fallRate   = state.cvFallRate;
+        route.slewFrames = 0;
+    }
+    
+    // Correlation-aware curve: one correlation per block
+    route.shaped      = c.curve == CURVE_ADAPTIVE;
+    route.correlation = c.correlation;
+    
+    // Mid/Side: the side's target only changes with Side Dest
+    route.midSide = c.midSide;
+    if (c.midSide && state.sideDest != c.sideDest) {
+        for (int d = 0; d < numDests; ++d) {
+            state.sideTargetGains[d] = (d == c.sideDest) ? 1.0f : 0.0f;
+            if (state.sideDest < 0) {
+                state.sideGains[d] = state.sideTargetGains[d];  // Entering Mid/Side: no fade in
             }
-            case CTRL_TRIG_REV: {
-                bool wasHigh = state.lastMidiValue > 63;
-                bool isHigh  = byte2 > 63;
-                if (isHigh && !wasHigh) {
-                    dest = (state.targetDest + numDests - 1) % numDests;
-                } else {
-                    dest = state.targetDest;
-                }
+        }
+        state.sideDest = c.sideDest;
+    } else if (!c.midSide) {
+        state.sideDest = -1;
+    }
+
+    if (!gesturePlaying(gs)) {
+        return mixGroup(state, route, 0, N);
+    }
+
+    // Playback: one compare per block unless an event falls inside it
+    if (gs.pos + (uint32_t)N <= gs.nextAt) {
+        setTargetDest(state, smxClamp((int)gs.dest, 0, numDests - 1), numDests);
+        const uint32_t touched = mixGroup(state, route, 0, N);
+        gs.pos += N;
+        return touched;
+    }
+    uint32_t touched = 0;
+    for (int n = 0; n < N; ) {
+        gestureApplyDue(gs);
+        setTargetDest(state, smxClamp((int)gs.dest, 0, numDests - 1), numDests);
+        const int seg = (int)std::min<uint32_t>((uint32_t)(N - n), gs.nextAt - gs.pos);
+        touched |= mixGroup(state, route, n, n + seg);
+        gs.pos += seg;
+        n      += seg;
+    }
+    return touched;
+}
+
+// Keeps a follower's state on its leader's so unlinking doesn't jump
+static inline void trackLeader(MixerGroupState& state, const MixerGroupState& lead, int numDests) {
+    state.targetDest = lead.targetDest;
+    for (int d = 0; d < numDests; ++d) {
+        state.destGains[d]   = lead.destGains[d];
+        state.targetGains[d] = lead.targetGains[d];
+    }
+    state.arbPending = true;  // Re-resolve if unlinked
+}
+
+/* ───── group arrays ───── */
+// Channel k of an array reads bus Input L + k and adds to Dest L + k of each
+// destination, mono and at the group's Volume. All channels share the one gain
+// envelope, so the loop per channel is a multiply-add per sample.
+static void mixArray(const SwitchingMixer* self, const GroupRoute& r, int base,
+                     const float* gains, float* buf, int N, uint32_t& clipBusses) {
+    const int   inBus = groupParam(self, base, GP_INPUT_L);
+    const float level = 2.0f * r.inGain[0];  // inGain halves the L+R sum
+    if (inBus <= 0 || level <= 0.0f) {
+        return;
+    }
+    for (int d = 0; d < r.numDests; ++d) {
+        const int outBus = groupParam(self, base, GP_DEST1_L + d * 2);
+        if (outBus <= 0) {
+            continue;
+        }
+        const float* g = gains + d * r.gainStride;
+        float peak = 0.0f;
+        for (int n = 0; n < N; ++n) {
+            peak = std::max(peak, g[n]);
+        }
+        if (peak * std::max(r.duck[d], r.duck[d] + r.duckInc[d] * N) <= 0.0001f) {
+            continue;  // Silent through this block
+        }
+        const float duck    = r.duck[d] * level;
+        const float duckInc = r.duckInc[d] * level;
+        for (int k = 0; k < self->numChannels; ++k) {
+            if (inBus + k > MAX_BUSSES || outBus + k > MAX_BUSSES) {
                 break;
             }
-            case CTRL_GATE:
-                dest = (byte2 > 63) ? std::min(1, numDests - 1) : 0;
-                break;
-            case CTRL_GATE_REV:
-                dest = (byte2 > 63) ? 0 : std::min(1, numDests - 1);
-                break;
-            default:
-                dest = state.targetDest;
-                break;
+            const float* in  = bus(buf, inBus + k, N);
+            float*       out = bus(buf, outBus + k, N);
+            for (int n = 0; n < N; ++n) {
+                out[n] += in[n] * g[n] * (duck + duckInc * n);
+            }
+            clipBusses |= busBit(outBus + k);
+        }
+    }
+}
+
+// Runs one array group: a leader decodes control and slews once, writing its
+// envelope to its gain buffer with no audio; a follower uses its leader's.
+static void processArray(SwitchingMixer* self, int g, MixerGroupState& state, GroupRoute& route,
+                         const GroupCoeffs& c, int base, float* buf, int N, float sampleRate,
+                         uint32_t& clipBusses) {
+    const int numDests = self->numDests;
+    const int lead     = self->leader[g];
+    const float* gains = self->gainBuffers + lead * numDests * route.gainStride;
+    if (lead != g) {
+        trackLeader(state, self->groupState[lead], numDests);
+    } else {
+        // Envelope pass: no destinations, and input only for the Env follower (channel 1)
+        GroupRoute env = route;
+        env.numInputs = (c.ctrlType == CTRL_ENV || c.ctrlType == CTRL_ENV_REV) ? 1 : 0;
+        env.inR[0]    = nullptr;
+        for (int d = 0; d < numDests; ++d) {
+            env.destL[d] = nullptr;
+            env.destR[d] = nullptr;
+        }
+        env.auxL    = nullptr;
+        env.auxR    = nullptr;
+        env.gainOut = self->gainBuffers + g * numDests * route.gainStride;
+        processGroup(self, state, env, c, base, buf, N, sampleRate);
+    }
+    mixArray(self, route, base, gains, buf, N, clipBusses);
+}
+
+/* ───── CPU governor ───── */
+// Folds one block's cost into the load average and steps the quality level:
+// down as soon as the average exceeds the budget, back up only once it has
+// stayed well under it, and never twice within the settle time.
+static void governorUpdate(SwitchingMixer* self, uint32_t cycles, int N, float sampleRate) {
+    const float blockCycles = CPU_CLOCK_HZ * (float)N / sampleRate;
+    const float alpha = std::min(1.0f, (float)N / (sampleRate * GOV_AVERAGE_SEC));
+    self->govLoad += ((float)cycles / blockCycles - self->govLoad) * alpha;
+    
+    if (self->govSettle > 0) {
+        self->govSettle -= std::min<uint32_t>(self->govSettle, N);
+        return;
+    }
+    const float budget = self->v[PARAM_CPU_BUDGET] * 0.01f;
+    const uint32_t settle = (uint32_t)(sampleRate * GOV_SETTLE_SEC);
+    if (self->govLoad > budget) {
+        self->govCalm = 0;
+        if (self->govLevel < GOV_LEVEL_COUNT - 1) {
+            ++self->govLevel;
+            self->govSettle = settle;
+        }
+    } else if (self->govLevel > GOV_FULL && self->govLoad < budget * GOV_RESTORE_RATIO) {
+        self->govCalm += N;
+        if (self->govCalm >= (uint32_t)(sampleRate * GOV_RESTORE_SEC)) {
+            --self->govLevel;
+            self->govCalm   = 0;
+            self->govSettle = settle;
+        }
+    } else {
+        self->govCalm = 0;
+    }
+}
+
+/* ───── DSP step ───── */
+static void step(_NT_algorithm* b, float* buf, int nBy4) {
+    SwitchingMixer* self = static_cast<SwitchingMixer*>(b);
+    const int N = nBy4 * 4;
+    
+    if (self->v[PARAM_BYPASS]) {
+        return;
+    }
+    
+    // Governor off: full quality, and no cycle counter reads
+    const bool     governed    = self->v[PARAM_CPU_BUDGET] > 0;
+    const uint32_t startCycles = governed ? NT_getCpuCycleCount() : 0;
+    if (!governed) {
+        self->govLevel = GOV_FULL;
+    }
+    
+    const float sampleRate    = getSampleRateFloat();
+    const int   numDests      = self->numDests;
+    const int   gainStride    = (int)self->maxFrames;
+    
+    // Parameter changes since the last block are applied here, once
+    if (self->dirty) {
+        updateCoeffs(self, sampleRate);
+    }
+    const int8_t* leader      = self->leader;
+    const bool*   hasFollowers = self->hasFollowers;
+    
+    // Ducking is control rate: one-pole per block, ramped linearly across it
+    float duckTarget[MAX_GROUPS][MAX_DESTINATIONS];
+    computeDuckTargets(self, duckTarget);
+    const float duckCoeff = 1.0f - std::exp(-(float)N / (sampleRate * DUCK_TIME_SEC));
+    const float invN      = 1.0f / (float)N;
+    
+    // Modulation CV ticks fall on block boundaries, CV Rate apart
+    const int  tickBlocks = std::max(1, (int)(sampleRate / ((float)self->v[PARAM_CV_RATE] * N) + 0.5f));
+    const int  tickFrames = tickBlocks * N;
+    const bool cvTick     = ++self->cvBlocks >= tickBlocks;
+    if (cvTick) {
+        self->cvBlocks = 0;
+    }
+    
+    const OutputClip clipType  = self->clipType;
+    const float      clipLevel = self->clipLevel;
+    uint32_t         clipBusses = 0;
+    
+    for (int g = 0; g < self->numGroups; ++g) {
+        const int base = groupBase(self, g);
+        MixerGroupState& state = self->groupState[g];
+        GroupCoeffs& c         = self->coeffs[g];
+
+        // Get bus pointers (dest count depends on numDests)
+        GroupRoute route;
+        route.inL[0]     = bus(buf, groupParam(self, base, GP_INPUT_L), N);
+        route.inR[0]     = bus(buf, groupParam(self, base, GP_INPUT_R), N);
+        route.inGain[0]  = c.inGain[0];
+        route.numInputs  = 1;
+        for (int i = 1; i < self->numInputs; ++i) {
+            const int off = GP_INPUT2_L + (i - 1) * 3;
+            float* extraL = bus(buf, groupParam(self, base, off), N);
+            float* extraR = bus(buf, groupParam(self, base, off + 1), N);
+            if ((!extraL && !extraR) || c.inGain[i] <= 0.0f) {
+                continue;  // Unused pairs cost nothing in the mix loop
+            }
+            route.inL[route.numInputs]    = extraL;
+            route.inR[route.numInputs]    = extraR;
+            route.inGain[route.numInputs] = c.inGain[i];
+            ++route.numInputs;
+        }
+        route.numDests   = numDests;
+        route.panGL      = c.panGL;
+        route.panGR      = c.panGR;
+        route.panGLInc   = 0.0f;
+        route.panGRInc   = 0.0f;
+        if (c.modCv) {
+            applyModCv(self, state, c, base, route, buf, N, tickFrames, cvTick, sampleRate);
+        }
+        route.gainStride = gainStride;
+        route.gainOut    = hasFollowers[g] ? self->gainBuffers + g * numDests * gainStride : nullptr;
+        route.quality    = self->govLevel;
+        const bool blockSlew = self->govLevel != GOV_FULL || c.curve >= CURVE_ADAPTIVE;
+        if (blockSlew && c.slewFrames != N) {
+            c.slewDecay  = std::pow(1.0f - c.slewRate, (float)N);
+            c.fallDecay  = (c.fallRate == c.slewRate) ? c.slewDecay : std::pow(1.0f - c.fallRate, (float)N);
+            c.slewFrames = N;
+        }
+        if (c.retrigger != RETRIG_CHASE && c.killFrames != N) {
+            c.killRate   = 1.0f - std::pow(KILL_GAIN, 1.0f / (float)N);
+            c.killDecay  = std::pow(1.0f - c.killRate, (float)N);
+            c.killFrames = N;
+        }
+        for (int d = 0; d < numDests; ++d) {
+            route.destL[d] = bus(buf, groupParam(self, base, GP_DEST1_L + d * 2), N);
+            route.destR[d] = bus(buf, groupParam(self, base, GP_DEST1_R + d * 2), N);
+        }
+        route.auxL    = bus(buf, groupParam(self, base, GP_AUX_L), N);
+        route.auxR    = bus(buf, groupParam(self, base, GP_AUX_R), N);
+        route.auxGain = c.auxGain;
+        route.auxPost = c.auxPost;
+        route.midSide = false;  // Set by processGroup for leaders
+        route.shaped  = false;
+        for (int d = 0; d < numDests; ++d) {
+            const float from = state.duckGain[d];
+            float to = from + (duckTarget[g][d] - from) * duckCoeff;
+            if (std::fabs(duckTarget[g][d] - to) < 0.0001f) {
+                to = duckTarget[g][d];
+            }
+            route.duck[d]     = from;
+            route.duckInc[d]  = (to - from) * invN;
+            state.duckGain[d] = to;
         }
         
-        state.lastMidiValue = byte2;
-        state.targetDest    = smxClamp(dest, 0, numDests - 1);
+        if (self->numChannels > 1) {
+            processArray(self, g, state, route, c, base, buf, N, sampleRate, clipBusses);
+            continue;
+        }
         
-        // Update target gains
+        // Latency compensation: delayed dests mix into scratch first
+        int    delays[MAX_DESTINATIONS];
+        float* realL[MAX_DESTINATIONS];
+        float* realR[MAX_DESTINATIONS];
+        const uint32_t delayMask = (self->maxDelay > 0)
+            ? redirectDelays(self, g, state, base, route, delays, realL, realR) : 0;
+        
+        uint32_t touched;
+        if (leader[g] != g) {
+            // Followers apply the leader's envelope and skip control and slew
+            touched = mixFollower(route, self->gainBuffers + leader[g] * numDests * gainStride, N);
+            trackLeader(state, self->groupState[leader[g]], numDests);
+        } else {
+            touched = processGroup(self, state, route, c, base, buf, N, sampleRate);
+        }
+        
+        if (delayMask) {
+            touched = (touched & ~delayMask)
+                    | applyDelays(self, g, state, delayMask, touched, delays, realL, realR, N);
+        }
+        
+        // Note which busses this group added to, for the clipper
         for (int d = 0; d < numDests; ++d) {
-            state.targetGains[d] = (d == state.targetDest) ? 1.0f : 0.0f;
+            if (touched & (1u << d)) {
+                clipBusses |= destBusMask(self, base, d);
+            }
+        }
+        if (touched & AUX_TOUCHED) {
+            clipBusses |= busBit(groupParam(self, base, GP_AUX_L))
+                        | busBit(groupParam(self, base, GP_AUX_R));
+        }
+    }
+    
+    // Clip each written destination bus once, after every group has added to it
+    if (clipType != CLIP_OFF) {
+        for (int i = 1; i <= MAX_BUSSES; ++i) {
+            if (clipBusses & busBit(i)) {
+                clipBus(bus(buf, i, N), N, clipType, clipLevel);
+            }
         }
     }
+    
+    if (governed) {
+        governorUpdate(self, NT_getCpuCycleCount() - startCycles, N, sampleRate);
+    }
+}
+
+/* ───── MIDI handling ───── */
+// Records a MIDI CC value as group g's MIDI source; step() arbitrates
+static void midiToGroup(SwitchingMixer* self, int g, uint8_t value) {
+    const int numDests = self->numDests;
+    MixerGroupState& state = self->groupState[g];
+    const int base = groupBase(self, g);
+    const ControlType ctrlType = (ControlType)smxClamp(
+        (int)groupParam(self, base, GP_CTRL_TYPE), 0, groupParamMax(self, base, GP_CTRL_TYPE));
+    const ArbitrationMode mode = (ArbitrationMode)smxClamp(
+        (int)groupParam(self, base, GP_ARBITRATION), 0, (int)ARB_MODE_COUNT - 1);
+    const int from = arbFrom(state, SRC_MIDI, mode);
+    
+    int dest = -1;
+    
+    switch (ctrlType) {
+        case CTRL_UNIPOLAR:
+        case CTRL_BIPOLAR: {
+            // CC 0-127 maps to destinations, or spans the custom zones' range
+            const GroupCoeffs& c = self->coeffs[g];
+            if (c.customZones) {
+                dest = zoneLookup(c.zoneLut, value * (ZONE_RANGE_VOLTS / 127.0f));
+                break;
+            }
+            float normalized = (value / 127.0f) * 0.9999f;
+            dest = (int)(normalized * numDests);
+            break;
+        }
+        case CTRL_TRIGGER: {
+            bool wasHigh = state.lastMidiValue > 63;
+            bool isHigh  = value > 63;
+            if (isHigh && !wasHigh) {
+                dest = (from + 1) % numDests;
+            }
+            break;
+        }
+        case CTRL_TRIG_REV: {
+            bool wasHigh = state.lastMidiValue > 63;
+            bool isHigh  = value > 63;
+            if (isHigh && !wasHigh) {
+                dest = (from + numDests - 1) % numDests;
+            }
+            break;
+        }
+        case CTRL_GATE:
+            dest = (value > 63) ? std::min(1, numDests - 1) : 0;
+            break;
+        case CTRL_GATE_REV:
+            dest = (value > 63) ? 0 : std::min(1, numDests - 1);
+            break;
+        default:
+            break;
+    }
+    
+    state.lastMidiValue = value;
+    if (dest >= 0) {
+        arbSource(state, SRC_MIDI, smxClamp(dest, 0, numDests - 1), isEdgeControl(ctrlType));
+    }
+}
+
+static void midiMessage(_NT_algorithm* b, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    SwitchingMixer* self = static_cast<SwitchingMixer*>(b);
+
+    const uint8_t status  = byte0 & 0xF0;
+    const uint8_t channel = (byte0 & 0x0F) + 1;
+
+    if (status != 0xB0) return; // CC only
+
+    // Global MIDI: one channel, and the group is the CC's offset from the base
+    if (self->numGlobals > GLOBAL_PARAM_COUNT) {
+        if (!self->v[PARAM_MIDI_ENABLE] || channel != self->v[PARAM_MIDI_CHANNEL]) return;
+        const int g = byte1 - self->v[PARAM_MIDI_BASE_CC];
+        if (g >= 0 && g < self->numGroups) {
+            midiToGroup(self, g, byte2);
+        }
+        return;
+    }
+
+    // Per-group MIDI: keys are rebuilt with the other coefficients in step()
+    const int16_t key = (int16_t)(((channel - 1) << 7) | (byte1 & 0x7F));
+    for (int g = 0; g < self->numGroups; ++g) {
+        if (self->midiKey[g] == key) {
+            midiToGroup(self, g, byte2);
+        }
+    }
+}
+
+/* ───── parameter changes ───── */
+// Only marks what needs rebuilding; step() does the work once per block
+static void parameterChanged(_NT_algorithm* b, int p) {
+    SwitchingMixer* self = static_cast<SwitchingMixer*>(b);
+    if (p == PARAM_CPU_BUDGET || p == PARAM_CV_RATE) {
+        return;  // Read directly by step()
+    }
+    if (p < self->numGlobals) {
+        // Global Fade feeds every group's slew rate
+        self->dirty |= (p == PARAM_GLOBAL_SLEW) ? DIRTY_ALL : DIRTY_SHARED;
+        return;
+    }
+    const int g = (p - self->numGlobals) / self->paramsPerGroup;
+    if (g < self->numGroups) {
+        self->dirty |= (1u << g) | DIRTY_SHARED;
+    }
 }
 
 /* ───── parameter UI prefix ───── */
 static int parameterUiPrefix(_NT_algorithm* alg, int p, char* buff) {
     SwitchingMixer* self = static_cast<SwitchingMixer*>(alg);
-    if (p < GLOBAL_PARAM_COUNT) {
+    if (p < self->numGlobals) {
         return 0;
     }
-    int groupIndex = (p - GLOBAL_PARAM_COUNT) / self->paramsPerGroup;
+    int groupIndex = (p - self->numGlobals) / self->paramsPerGroup;
     int len = NT_intToString(buff, 1 + groupIndex);
     buff[len++] = ':';
     buff[len]   = '\0';
@@ -601,7 +2631,7 @@ static const _NT_factory gFactory = {
     .initialise           = nullptr,
     .calculateRequirements = calcReq,
     .construct            = construct,
-    .parameterChanged     = nullptr,
+    .parameterChanged     = parameterChanged,
     .step                 = step,
     .draw                 = nullptr,
     .midiRealtime         = nullptr,
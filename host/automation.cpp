@@ -0,0 +1,352 @@
+/*
+ * Timed input for offline renders.
+ */
+
+#include "automation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const char     SWA_MAGIC[8]   = { 'S', 'W', 'M', 'X', 'A', 'U', 'T', 'O' };
+static const uint32_t SWA_VERSION    = 1;
+static const uint32_t SMF_DEFAULT_TEMPO = 500000;  // µs per quarter note (120 BPM)
+
+static bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    bytes.clear();
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    }
+    const bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/* ───── Standard MIDI File ───── */
+struct SmfEvent {
+    uint64_t tick;
+    uint32_t tempo;  // non-zero for a tempo change
+    uint8_t  msg[3];
+};
+
+// Variable-length quantity; false if it runs off the end
+static bool readVarLen(const uint8_t*& p, const uint8_t* end, uint32_t& out) {
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (p >= end) {
+            return false;
+        }
+        const uint8_t b = *p++;
+        out = (out << 7) | (b & 0x7F);
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseTrack(const uint8_t* p, const uint8_t* end, std::vector<SmfEvent>& out) {
+    uint64_t tick    = 0;
+    uint8_t  running = 0;
+    while (p < end) {
+        uint32_t delta;
+        if (!readVarLen(p, end, delta) || p >= end) {
+            return false;
+        }
+        tick += delta;
+
+        uint8_t status = *p;
+        if (status == 0xFF) {
+            if (end - p < 2) {
+                return false;
+            }
+            const uint8_t type = p[1];
+            p += 2;
+            uint32_t len;
+            if (!readVarLen(p, end, len) || (uint32_t)(end - p) < len) {
+                return false;
+            }
+            if (type == 0x51 && len == 3) {
+                out.push_back({ tick, ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2], { 0, 0, 0 } });
+            } else if (type == 0x2F) {
+                return true;
+            }
+            p += len;
+            continue;
+        }
+        if (status == 0xF0 || status == 0xF7) {
+            ++p;
+            uint32_t len;
+            if (!readVarLen(p, end, len) || (uint32_t)(end - p) < len) {
+                return false;
+            }
+            p += len;
+            running = 0;
+            continue;
+        }
+
+        if (status & 0x80) {
+            ++p;
+            running = status;
+        } else if (running) {
+            status = running;
+        } else {
+            return false;
+        }
+        const int dataBytes = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+        if (end - p < dataBytes) {
+            return false;
+        }
+        SmfEvent e = { tick, 0, { status, p[0], (uint8_t)(dataBytes == 2 ? p[1] : 0) } };
+        out.push_back(e);
+        p += dataBytes;
+    }
+    return true;
+}
+
+static bool loadSmf(const std::vector<uint8_t>& bytes, uint32_t sampleRate,
+                    std::vector<AutomationEvent>& events, std::string& err) {
+    const uint8_t* p   = bytes.data();
+    const uint8_t* end = p + bytes.size();
+    if (bytes.size() < 14 || be32(p + 4) < 6) {
+        err = "truncated MIDI file header";
+        return false;
+    }
+    const uint16_t numTracks = be16(p + 10);
+    const uint16_t division  = be16(p + 12);
+    p += 8 + be32(p + 4);
+
+    std::vector<SmfEvent> smf;
+    for (int t = 0; t < numTracks && end - p >= 8; ++t) {
+        const uint32_t len = be32(p + 4);
+        const uint8_t* body = p + 8;
+        if ((uint64_t)(end - body) < len) {
+            err = "truncated MIDI track";
+            return false;
+        }
+        if (memcmp(p, "MTrk", 4) == 0 && !parseTrack(body, body + len, smf)) {
+            err = "malformed MIDI track";
+            return false;
+        }
+        p = body + len;
+    }
+    // Merge the tracks; equal ticks keep file order, so tempo changes in the
+    // first track apply before notes at the same tick
+    std::stable_sort(smf.begin(), smf.end(),
+                     [](const SmfEvent& a, const SmfEvent& b) { return a.tick < b.tick; });
+
+    // Seconds per tick: SMPTE is fixed, PPQN follows the tempo map
+    const bool   smpte = (division & 0x8000) != 0;
+    const double smpteTick = smpte
+        ? 1.0 / ((double)-(int8_t)(division >> 8) * (division & 0xFF)) : 0.0;
+    const int    ppqn = smpte ? 1 : std::max<int>(1, division);
+    double   tickSec  = smpte ? smpteTick : SMF_DEFAULT_TEMPO * 1e-6 / ppqn;
+    double   seconds  = 0.0;
+    uint64_t lastTick = 0;
+
+    events.clear();
+    for (const SmfEvent& e : smf) {
+        seconds += (double)(e.tick - lastTick) * tickSec;
+        lastTick = e.tick;
+        if (e.tempo) {
+            if (!smpte) {
+                tickSec = e.tempo * 1e-6 / ppqn;
+            }
+            continue;
+        }
+        AutomationEvent a = {};
+        a.frame = (uint64_t)std::llround(seconds * sampleRate);
+        a.type  = AUTO_MIDI;
+        memcpy(a.midi, e.msg, 3);
+        events.push_back(a);
+    }
+    return true;
+}
+
+/* ───── binary ───── */
+static bool loadBinary(const std::vector<uint8_t>& bytes, uint32_t sampleRate,
+                       std::vector<AutomationEvent>& events, std::string& err) {
+    const uint8_t* p   = bytes.data();
+    const uint8_t* end = p + bytes.size();
+    uint32_t version, fileRate, count;
+    if (bytes.size() < 20) {
+        err = "truncated automation header";
+        return false;
+    }
+    memcpy(&version, p + 8, 4);
+    memcpy(&fileRate, p + 12, 4);
+    memcpy(&count, p + 16, 4);
+    p += 20;
+    if (version != SWA_VERSION || fileRate == 0) {
+        err = "unsupported automation file version";
+        return false;
+    }
+
+    events.clear();
+    events.reserve(count);
+    uint64_t frame = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t delta;
+        if (end - p < 5) {
+            err = "truncated automation event";
+            return false;
+        }
+        memcpy(&delta, p, 4);
+        frame += delta;
+        AutomationEvent e = {};
+        e.type  = p[4];
+        e.frame = (fileRate == sampleRate) ? frame
+                : (uint64_t)std::llround((double)frame * sampleRate / fileRate);
+        p += 5;
+        const int size = (e.type == AUTO_MIDI) ? 3 : (e.type == AUTO_PARAM) ? 4 : (e.type == AUTO_CV) ? 5 : -1;
+        if (size < 0 || end - p < size) {
+            err = "malformed automation event";
+            return false;
+        }
+        if (e.type == AUTO_MIDI) {
+            memcpy(e.midi, p, 3);
+        } else if (e.type == AUTO_PARAM) {
+            memcpy(&e.target, p, 2);
+            memcpy(&e.value, p + 2, 2);
+        } else {
+            e.target = p[0];
+            memcpy(&e.volts, p + 1, 4);
+        }
+        p += size;
+        events.push_back(e);
+    }
+    return true;
+}
+
+bool automationSave(const char* path, uint32_t sampleRate,
+                    const std::vector<AutomationEvent>& events) {
+    std::vector<uint8_t> out(SWA_MAGIC, SWA_MAGIC + sizeof(SWA_MAGIC));
+    auto put = [&out](const void* v, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(v);
+        out.insert(out.end(), b, b + n);
+    };
+    const uint32_t count = (uint32_t)events.size();
+    put(&SWA_VERSION, 4);
+    put(&sampleRate, 4);
+    put(&count, 4);
+
+    uint64_t last = 0;
+    for (const AutomationEvent& e : events) {
+        // Gaps longer than a u32 (a day at 48 kHz) aren't representable
+        const uint32_t delta = (uint32_t)std::min<uint64_t>(e.frame - last, UINT32_MAX);
+        last = e.frame;
+        put(&delta, 4);
+        put(&e.type, 1);
+        if (e.type == AUTO_MIDI) {
+            put(e.midi, 3);
+        } else if (e.type == AUTO_PARAM) {
+            put(&e.target, 2);
+            put(&e.value, 2);
+        } else {
+            const uint8_t bus = (uint8_t)e.target;
+            put(&bus, 1);
+            put(&e.volts, 4);
+        }
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    const bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+    return (fclose(f) == 0) && ok;
+}
+
+/* ───── loading ───── */
+bool automationLoad(const char* path, uint32_t sampleRate,
+                    std::vector<AutomationEvent>& events, std::string& err) {
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes)) {
+        err = "can't read";
+        return false;
+    }
+    if (bytes.size() >= 4 && memcmp(bytes.data(), "MThd", 4) == 0) {
+        return loadSmf(bytes, sampleRate, events, err);
+    }
+    if (bytes.size() >= 8 && memcmp(bytes.data(), SWA_MAGIC, 8) == 0) {
+        return loadBinary(bytes, sampleRate, events, err);
+    }
+    err = "not a MIDI or SwMx automation file";
+    return false;
+}
+
+bool automationLoadText(const char* path, std::vector<AutomationEvent>& events,
+                        std::string& err) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        err = "can't read";
+        return false;
+    }
+    events.clear();
+    char line[256];
+    int  lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        if (char* hash = strchr(line, '#')) {
+            *hash = '\0';
+        }
+        unsigned long long frame;
+        char kind[16];
+        int  used = 0;
+        if (sscanf(line, " %llu %15s %n", &frame, kind, &used) < 2) {
+            ok = (sscanf(line, " %15s", kind) < 1);  // blank or comment
+            continue;
+        }
+        AutomationEvent e = {};
+        e.frame = frame;
+        const char* args = line + used;
+        unsigned a, b, c;
+        int   index, value;
+        float volts;
+        if (!strcmp(kind, "midi") && sscanf(args, "%u %u %u", &a, &b, &c) == 3
+            && a <= 0xFF && b <= 0x7F && c <= 0x7F) {
+            e.type = AUTO_MIDI;
+            e.midi[0] = (uint8_t)a;
+            e.midi[1] = (uint8_t)b;
+            e.midi[2] = (uint8_t)c;
+        } else if (!strcmp(kind, "param") && sscanf(args, "%d %d", &index, &value) == 2
+                   && index >= 0 && index <= UINT16_MAX && value >= INT16_MIN && value <= INT16_MAX) {
+            e.type   = AUTO_PARAM;
+            e.target = (uint16_t)index;
+            e.value  = (int16_t)value;
+        } else if (!strcmp(kind, "cv") && sscanf(args, "%u %f", &a, &volts) == 2
+                   && a >= 1 && a <= 28) {
+            e.type   = AUTO_CV;
+            e.target = (uint16_t)a;
+            e.volts  = volts;
+        } else {
+            ok = false;
+            continue;
+        }
+        events.push_back(e);
+    }
+    fclose(f);
+    if (!ok) {
+        err = "syntax error on line " + std::to_string(lineNo);
+        return false;
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const AutomationEvent& x, const AutomationEvent& y) { return x.frame < y.frame; });
+    return true;
+}
@@ -0,0 +1,187 @@
+/*
+ * Session capture for the SwMx host.
+ */
+
+#include "capture.h"
+
+#include <cstring>
+
+static const char     SWC_MAGIC[8] = { 'S', 'W', 'M', 'X', 'C', 'A', 'P', 'T' };
+static const uint32_t SWC_VERSION  = 1;
+static const int      SWC_MAX_BUSSES = 32;  // width of the stored-bus mask
+
+uint64_t captureHash(const float* busses, int numBusses, int numFrames) {
+    const uint8_t* p   = reinterpret_cast<const uint8_t*>(busses);
+    const size_t   len = (size_t)numBusses * numFrames * sizeof(float);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// True if any sample has a bit set, so -0.0 and denormals are stored too
+static bool busHasBits(const float* b, int numFrames) {
+    for (int i = 0; i < numFrames; ++i) {
+        uint32_t bits;
+        memcpy(&bits, b + i, 4);
+        if (bits) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ───── writing ───── */
+bool CaptureWriter::open(const char* path, const CaptureHeader& header) {
+    close();
+    f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    ok = true;
+    const uint32_t numSpecs = (uint32_t)header.specs.size();
+    put(SWC_MAGIC, sizeof(SWC_MAGIC));
+    put(&SWC_VERSION, 4);
+    put(&header.sampleRate, 4);
+    put(&header.maxFrames, 4);
+    put(&numSpecs, 4);
+    put(header.specs.data(), numSpecs * sizeof(int32_t));
+    return ok;
+}
+
+void CaptureWriter::put(const void* v, size_t n) {
+    ok = ok && fwrite(v, 1, n, f) == n;
+}
+
+void CaptureWriter::param(int p, int16_t value) {
+    const uint8_t  type  = CAPTURE_PARAM;
+    const uint16_t index = (uint16_t)p;
+    put(&type, 1);
+    put(&index, 2);
+    put(&value, 2);
+}
+
+void CaptureWriter::midi(uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    const uint8_t rec[4] = { CAPTURE_MIDI, byte0, byte1, byte2 };
+    put(rec, sizeof(rec));
+}
+
+void CaptureWriter::stepBegin(const float* busses, int numBusses, int numFrames) {
+    const uint8_t  type   = CAPTURE_STEP;
+    const uint16_t frames = (uint16_t)numFrames;
+    uint32_t mask = 0;
+    for (int b = 0; b < numBusses && b < SWC_MAX_BUSSES; ++b) {
+        if (busHasBits(busses + b * numFrames, numFrames)) {
+            mask |= 1u << b;
+        }
+    }
+    put(&type, 1);
+    put(&frames, 2);
+    put(&mask, 4);
+    for (uint32_t m = mask; m; m &= m - 1) {
+        put(busses + __builtin_ctz(m) * numFrames, numFrames * sizeof(float));
+    }
+}
+
+void CaptureWriter::stepEnd(const uint32_t* cycles, int numCycles, const float* busses,
+                            int numBusses, int numFrames) {
+    const uint8_t  count = (uint8_t)numCycles;
+    const uint64_t hash  = captureHash(busses, numBusses, numFrames);
+    put(&count, 1);
+    put(cycles, numCycles * sizeof(uint32_t));
+    put(&hash, 8);
+}
+
+bool CaptureWriter::close() {
+    if (!f) {
+        return true;
+    }
+    const bool flushed = (fclose(f) == 0) && ok;
+    f = nullptr;
+    return flushed;
+}
+
+/* ───── reading ───── */
+bool CaptureReader::get(void* v, size_t n) {
+    return fread(v, 1, n, f) == n;
+}
+
+bool CaptureReader::open(const char* path, CaptureHeader& header, std::string& err) {
+    close();
+    f = fopen(path, "rb");
+    if (!f) {
+        err = "can't read";
+        return false;
+    }
+    char     magic[8];
+    uint32_t version, numSpecs;
+    if (!get(magic, 8) || memcmp(magic, SWC_MAGIC, 8) != 0) {
+        err = "not a SwMx capture file";
+        return false;
+    }
+    if (!get(&version, 4) || !get(&header.sampleRate, 4) || !get(&header.maxFrames, 4)
+        || !get(&numSpecs, 4)) {
+        err = "truncated capture header";
+        return false;
+    }
+    if (version != SWC_VERSION || header.sampleRate == 0 || header.maxFrames == 0
+        || header.maxFrames > UINT16_MAX || numSpecs > 64) {
+        err = "unsupported capture file version";
+        return false;
+    }
+    header.specs.resize(numSpecs);
+    if (!get(header.specs.data(), numSpecs * sizeof(int32_t))) {
+        err = "truncated capture header";
+        return false;
+    }
+    maxFrames   = (int)header.maxFrames;
+    firstRecord = ftell(f);
+    return true;
+}
+
+bool CaptureReader::next(CaptureRecord& rec, float* busses, int numBusses, std::string& err) {
+    err.clear();
+    if (!get(&rec.type, 1)) {
+        return false;  // clean end of file
+    }
+    bool ok = false;
+    if (rec.type == CAPTURE_PARAM) {
+        ok = get(&rec.param, 2) && get(&rec.value, 2);
+    } else if (rec.type == CAPTURE_MIDI) {
+        ok = get(rec.midi, 3);
+    } else if (rec.type == CAPTURE_STEP) {
+        uint16_t frames;
+        uint32_t mask;
+        uint8_t  count;
+        ok = get(&frames, 2) && get(&mask, 4) && frames > 0 && frames <= maxFrames
+          && (numBusses >= SWC_MAX_BUSSES || (mask >> numBusses) == 0);
+        rec.numFrames = frames;
+        if (ok) {
+            memset(busses, 0, (size_t)numBusses * frames * sizeof(float));
+            for (uint32_t m = mask; m && ok; m &= m - 1) {
+                ok = get(busses + __builtin_ctz(m) * frames, frames * sizeof(float));
+            }
+        }
+        ok = ok && get(&count, 1) && count <= CAPTURE_MAX_CYCLES;
+        rec.numCycles = count;
+        ok = ok && get(rec.cycles, count * sizeof(uint32_t)) && get(&rec.hash, 8);
+    }
+    if (!ok) {
+        err = "malformed capture record";
+    }
+    return ok;
+}
+
+void CaptureReader::rewind() {
+    if (f) {
+        fseek(f, firstRecord, SEEK_SET);
+    }
+}
+
+void CaptureReader::close() {
+    if (f) {
+        fclose(f);
+        f = nullptr;
+    }
+}
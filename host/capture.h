@@ -0,0 +1,111 @@
+/*
+ * Session capture for the SwMx host: everything an instance's step() and
+ * midiMessage() see, in order, so a session can be re-run bit-exactly under
+ * a debugger or profiler (swmx_replay).
+ *
+ * Parameter values are recorded as changes; replaying them in order gives
+ * each step() the same v[] the captured one saw. Input busses are stored
+ * only when they hold a non-zero bit, and each step's CPU cycle readings
+ * are kept so the CPU Budget governor replays its decisions.
+ *
+ * .swc layout (little-endian):
+ *   "SWMXCAPT"  u32 version (1)  u32 sample rate  u32 max frames per step
+ *   u32 spec count, then an i32 per spec
+ *   records, each starting with a u8 CaptureType:
+ *     CAPTURE_PARAM  u16 parameter index, i16 value
+ *     CAPTURE_MIDI   3 bytes of message
+ *     CAPTURE_STEP   u16 frames, u32 mask of stored busses (bit 0 = bus 1),
+ *                    frames f32 per stored bus, u8 cycle reading count,
+ *                    u32 per reading, u64 hash of every bus after step()
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum CaptureType : uint8_t {
+    CAPTURE_PARAM = 0,
+    CAPTURE_MIDI  = 1,
+    CAPTURE_STEP  = 2,
+};
+
+constexpr int CAPTURE_MAX_CYCLES = 8;  // NT_getCpuCycleCount() readings per step
+
+struct CaptureHeader {
+    uint32_t             sampleRate;
+    uint32_t             maxFrames;
+    std::vector<int32_t> specs;
+};
+
+struct CaptureRecord {
+    uint8_t  type;
+    uint16_t param;    // CAPTURE_PARAM
+    int16_t  value;
+    uint8_t  midi[3];  // CAPTURE_MIDI
+    int      numFrames;                    // CAPTURE_STEP
+    int      numCycles;
+    uint32_t cycles[CAPTURE_MAX_CYCLES];
+    uint64_t hash;                         // of the busses after step()
+};
+
+// FNV-1a over the bit patterns of numBusses busses of numFrames
+uint64_t captureHash(const float* busses, int numBusses, int numFrames);
+
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+    ~CaptureWriter() { close(); }
+
+    bool open(const char* path, const CaptureHeader& header);
+    bool isOpen() const { return f != nullptr; }
+
+    void param(int p, int16_t value);
+    void midi(uint8_t byte0, uint8_t byte1, uint8_t byte2);
+
+    // Around one step(): the busses as step() receives them, then its cycle
+    // readings and the busses it left behind
+    void stepBegin(const float* busses, int numBusses, int numFrames);
+    void stepEnd(const uint32_t* cycles, int numCycles, const float* busses, int numBusses,
+                 int numFrames);
+
+    // Returns false if any write failed
+    bool close();
+
+private:
+    void put(const void* v, size_t n);
+
+    FILE* f  = nullptr;
+    bool  ok = true;
+};
+
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    ~CaptureReader() { close(); }
+
+    bool open(const char* path, CaptureHeader& header, std::string& err);
+
+    // Reads the next record. A CAPTURE_STEP's inputs are written to busses
+    // (numBusses of rec.numFrames), unstored busses as silence. Returns false
+    // at the end of the file, or with err set if the file is malformed.
+    bool next(CaptureRecord& rec, float* busses, int numBusses, std::string& err);
+
+    // Back to the first record, for repeated replays
+    void rewind();
+
+    void close();
+
+private:
+    bool get(void* v, size_t n);
+
+    FILE* f = nullptr;
+    long  firstRecord = 0;
+    int   maxFrames = 0;
+};
@@ -0,0 +1,13 @@
+/*
+ * NT_globals storage for the desktop host. Deliberately does not include
+ * <distingnt/api.h>; see nt_globals.h.
+ */
+
+#include "nt_globals.h"
+
+extern "C" NtHostGlobals NT_globals;
+NtHostGlobals NT_globals = { 48000, 128, nullptr, 0 };
+
+NtHostGlobals& ntHostGlobals() {
+    return NT_globals;
+}
@@ -0,0 +1,19 @@
+/*
+ * Writable storage for the API's NT_globals.
+ * The API declares NT_globals const because plugins only read it; the host
+ * has to fill it in. nt_globals.cpp defines the symbol without including
+ * <distingnt/api.h>, and nt_host.cpp checks the layouts match.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+struct NtHostGlobals {
+    uint32_t sampleRate;
+    uint32_t maxFramesPerStep;
+    float*   workBuffer;
+    uint32_t workBufferSizeBytes;
+};
+
+NtHostGlobals& ntHostGlobals();
@@ -0,0 +1,213 @@
+/*
+ * Desktop host for the Switching Mixer (SwMx).
+ */
+
+#include "nt_host.h"
+#include "nt_globals.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(NtHostGlobals) == sizeof(_NT_globals), "NT_globals layout mismatch");
+static_assert(offsetof(NtHostGlobals, sampleRate) == offsetof(_NT_globals, sampleRate),
+              "NT_globals layout mismatch");
+static_assert(offsetof(NtHostGlobals, maxFramesPerStep) == offsetof(_NT_globals, maxFramesPerStep),
+              "NT_globals layout mismatch");
+
+extern "C" uintptr_t pluginEntry(_NT_selector s, uint32_t i);
+
+/* ───── API symbols used by the algorithm ───── */
+extern "C" int NT_intToString(char* buffer, int32_t value) {
+    return sprintf(buffer, "%d", (int)value);
+}
+
+static thread_local NtHostCycleLog* tCycleLog = nullptr;
+static thread_local uint32_t (*tCycleClock)() = nullptr;
+
+// Cycle counter of the NT's 600 MHz core, emulated from the wall clock so the
+// CPU Budget governor sees the same scale it does on hardware
+extern "C" uint32_t NT_getCpuCycleCount(void) {
+    NtHostCycleLog* log = tCycleLog;
+    if (log && log->replay) {
+        return (log->next < log->count) ? log->values[log->next++] : 0;
+    }
+    uint32_t cycles;
+    if (tCycleClock) {
+        cycles = tCycleClock();
+    } else {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        cycles = (uint32_t)((uint64_t)ns * 3 / 5);
+    }
+    if (log && log->count < CAPTURE_MAX_CYCLES) {
+        log->values[log->count++] = cycles;
+    }
+    return cycles;
+}
+
+void ntHostSetCycleLog(NtHostCycleLog* log) {
+    tCycleLog = log;
+}
+
+void ntHostSetCycleClock(uint32_t (*clock)()) {
+    tCycleClock = clock;
+}
+
+/* ───── globals ───── */
+void ntHostSetGlobals(uint32_t sampleRate, uint32_t maxFramesPerStep) {
+    NtHostGlobals& g = ntHostGlobals();
+    g.sampleRate       = sampleRate;
+    g.maxFramesPerStep = maxFramesPerStep;
+}
+
+uint32_t ntHostSampleRate() {
+    return ntHostGlobals().sampleRate;
+}
+
+uint32_t ntHostMaxFrames() {
+    return ntHostGlobals().maxFramesPerStep;
+}
+
+const _NT_factory* ntHostFactory() {
+    return reinterpret_cast<const _NT_factory*>(pluginEntry(kNT_selector_factoryInfo, 0));
+}
+
+int ntHostFindSpec(const char* name) {
+    const _NT_factory* f = ntHostFactory();
+    for (uint32_t i = 0; i < f->numSpecifications; ++i) {
+        if (strcmp(f->specifications[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void ntHostDefaultSpecs(int32_t* specs) {
+    const _NT_factory* f = ntHostFactory();
+    for (uint32_t i = 0; i < f->numSpecifications; ++i) {
+        specs[i] = f->specifications[i].def;
+    }
+}
+
+/* ───── instance ───── */
+bool SwmxInstance::init(const int32_t* specs) {
+    stopCapture();
+    const _NT_factory* f = ntHostFactory();
+    for (uint32_t i = 0; i < f->numSpecifications; ++i) {
+        if (specs[i] < f->specifications[i].min || specs[i] > f->specifications[i].max) {
+            return false;
+        }
+    }
+
+    _NT_algorithmRequirements req;
+    memset(&req, 0, sizeof(req));
+    f->calculateRequirements(req, specs);
+
+    // Zeroed so renders are deterministic; the hardware makes no such promise
+    sram.assign(req.sram, 0);
+    dram.assign(req.dram, 0);
+    dtc.assign(req.dtc, 0);
+    itc.assign(req.itc, 0);
+
+    _NT_algorithmMemoryPtrs mem;
+    mem.sram = sram.data();
+    mem.dram = dram.data();
+    mem.dtc  = dtc.data();
+    mem.itc  = itc.data();
+    alg = f->construct(mem, req, specs);
+    if (!alg) {
+        return false;
+    }
+    specValues.assign(specs, specs + f->numSpecifications);
+
+    values.resize(req.numParameters);
+    for (uint32_t p = 0; p < req.numParameters; ++p) {
+        values[p] = alg->parameters[p].def;
+    }
+    alg->v = values.data();
+    if (f->parameterChanged) {
+        for (uint32_t p = 0; p < req.numParameters; ++p) {
+            f->parameterChanged(alg, (int)p);
+        }
+    }
+
+    busses.assign(NT_HOST_NUM_BUSSES * ntHostMaxFrames(), 0.0f);
+    return true;
+}
+
+void SwmxInstance::setValue(int p, int16_t v) {
+    const _NT_parameter& param = alg->parameters[p];
+    v = std::min(std::max(v, param.min), param.max);
+    if (values[p] == v) {
+        return;
+    }
+    values[p] = v;
+    if (capture) {
+        capture->param(p, v);
+    }
+    const _NT_factory* f = ntHostFactory();
+    if (f->parameterChanged) {
+        f->parameterChanged(alg, p);
+    }
+}
+
+bool SwmxInstance::startCapture(const char* path) {
+    stopCapture();
+    CaptureHeader header = { ntHostSampleRate(), ntHostMaxFrames(), specValues };
+    capture.reset(new CaptureWriter());
+    if (!capture->open(path, header)) {
+        capture.reset();
+        return false;
+    }
+    // Values already set away from their defaults
+    for (int p = 0; p < numParameters(); ++p) {
+        if (values[p] != alg->parameters[p].def) {
+            capture->param(p, values[p]);
+        }
+    }
+    return true;
+}
+
+bool SwmxInstance::stopCapture() {
+    if (!capture) {
+        return true;
+    }
+    const bool ok = capture->close();
+    capture.reset();
+    return ok;
+}
+
+void SwmxInstance::parameterName(int p, char* out, int size) const {
+    char prefix[16] = "";
+    const _NT_factory* f = ntHostFactory();
+    if (f->parameterUiPrefix) {
+        f->parameterUiPrefix(alg, p, prefix);
+    }
+    snprintf(out, size, "%s%s", prefix, alg->parameters[p].name);
+}
+
+void SwmxInstance::step(int numFrames) {
+    if (!capture) {
+        ntHostFactory()->step(alg, busses.data(), numFrames / 4);
+        return;
+    }
+    capture->stepBegin(busses.data(), NT_HOST_NUM_BUSSES, numFrames);
+    NtHostCycleLog log = {};
+    ntHostSetCycleLog(&log);
+    ntHostFactory()->step(alg, busses.data(), numFrames / 4);
+    ntHostSetCycleLog(nullptr);
+    capture->stepEnd(log.values, log.count, busses.data(), NT_HOST_NUM_BUSSES, numFrames);
+}
+
+void SwmxInstance::midiMessage(uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    if (capture) {
+        capture->midi(byte0, byte1, byte2);
+    }
+    const _NT_factory* f = ntHostFactory();
+    if (f->midiMessage) {
+        f->midiMessage(alg, byte0, byte1, byte2);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Desktop host for the Switching Mixer (SwMx).
+ * Runs the unmodified algorithm from SwitchingMixer.cpp outside the Disting NT:
+ * provides the API symbols it links against and owns one instance's memory
+ * regions, parameter values and 28-bus frame buffer.
+ */
+
+#pragma once
+
+#include "capture.h"
+
+#include <distingnt/api.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+constexpr int NT_HOST_NUM_BUSSES = 28;
+
+// Sets NT_globals. Must be called before any instance is constructed; all
+// instances in a process share one sample rate and maximum block size.
+void ntHostSetGlobals(uint32_t sampleRate, uint32_t maxFramesPerStep);
+uint32_t ntHostSampleRate();
+uint32_t ntHostMaxFrames();
+
+// The SwMx factory, as returned by pluginEntry()
+const _NT_factory* ntHostFactory();
+
+// Index of a specification by name, or -1
+int ntHostFindSpec(const char* name);
+
+// Fills specs with the factory defaults
+void ntHostDefaultSpecs(int32_t* specs);
+
+// NT_getCpuCycleCount() readings on the calling thread. While a log is set,
+// readings are appended to it, or with `replay` taken from it in order.
+struct NtHostCycleLog {
+    uint32_t values[CAPTURE_MAX_CYCLES];
+    int      count;
+    int      next;
+    bool     replay;
+};
+void ntHostSetCycleLog(NtHostCycleLog* log);
+
+// Replaces the wall clock behind NT_getCpuCycleCount() on the calling thread,
+// e.g. with a counter that makes every block look expensive; nullptr restores it
+void ntHostSetCycleClock(uint32_t (*clock)());
+
+class SwmxInstance {
+public:
+    SwmxInstance() : alg(nullptr) {}
+    SwmxInstance(const SwmxInstance&) = delete;
+    SwmxInstance& operator=(const SwmxInstance&) = delete;
+
+    // Builds the algorithm from one value per factory specification.
+    // Returns false if the specs are rejected. Ends any capture.
+    bool init(const int32_t* specs);
+
+    // Records the session from here on into a .swc file (see capture.h):
+    // start right after init() so swmx_replay rebuilds the same state.
+    // stopCapture() returns false if any write failed.
+    bool startCapture(const char* path);
+    bool stopCapture();
+
+    int numParameters() const { return (int)values.size(); }
+    const _NT_parameter& parameter(int p) const { return alg->parameters[p]; }
+    int16_t value(int p) const { return values[p]; }
+
+    // Clamps to the parameter range and notifies the algorithm if it changed
+    void setValue(int p, int16_t v);
+
+    // Display name with the algorithm's UI prefix, e.g. "2:Input L"
+    void parameterName(int p, char* out, int size) const;
+
+    // Bus buffer for a block of numFrames: bus i (1-based) starts at
+    // busFrames() + (i - 1) * numFrames, as step() expects
+    float* busFrames() { return busses.data(); }
+
+    // numFrames must be a multiple of 4, at most ntHostMaxFrames()
+    void step(int numFrames);
+    void midiMessage(uint8_t byte0, uint8_t byte1, uint8_t byte2);
+
+private:
+    _NT_algorithm*       alg;
+    std::vector<uint8_t> sram;
+    std::vector<uint8_t> dram;
+    std::vector<uint8_t> dtc;
+    std::vector<uint8_t> itc;
+    std::vector<int16_t> values;
+    std::vector<float>   busses;
+    std::vector<int32_t> specValues;
+    std::unique_ptr<CaptureWriter> capture;
+};
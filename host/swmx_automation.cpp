@@ -0,0 +1,49 @@
+/*
+ * Converts a Standard MIDI File or text automation lane into the compact
+ * .swa format read by swmx_render.
+ *
+ * Usage: swmx_automation [-r RATE] input.(mid|txt) output.swa
+ *   -r RATE   sample rate the frames are stamped at (default: 48000)
+ */
+
+#include "automation.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    uint32_t rate = 48000;
+    int arg = 1;
+    if (argc > 2 && !strcmp(argv[1], "-r")) {
+        rate = (uint32_t)atoi(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg != 2 || rate == 0) {
+        fprintf(stderr, "usage: swmx_automation [-r RATE] input.(mid|txt) output.swa\n");
+        return 2;
+    }
+    const char* in  = argv[arg];
+    const char* out = argv[arg + 1];
+
+    std::vector<AutomationEvent> events;
+    std::string err;
+    FILE* f = fopen(in, "rb");
+    char magic[4] = {};
+    const bool binary = f && fread(magic, 1, 4, f) == 4 && (!memcmp(magic, "MThd", 4) || !memcmp(magic, "SWMX", 4));
+    if (f) {
+        fclose(f);
+    }
+    const bool loaded = binary ? automationLoad(in, rate, events, err)
+                               : automationLoadText(in, events, err);
+    if (!loaded) {
+        fprintf(stderr, "swmx_automation: %s: %s\n", in, err.c_str());
+        return 1;
+    }
+    if (!automationSave(out, rate, events)) {
+        fprintf(stderr, "swmx_automation: can't write %s\n", out);
+        return 1;
+    }
+    fprintf(stderr, "swmx_automation: %zu events at %u Hz\n", events.size(), rate);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * LV2 wrapper for the Switching Mixer (SwMx).
+ * Runs construct/step/midiMessage from SwitchingMixer.cpp unchanged on a
+ * fixed SWMX_LV2_BLOCK-frame schedule, so routing matches the module sample
+ * for sample at any host buffer size.
+ *
+ * With SWMX_CAPTURE set in the environment, each instance captures its
+ * session to $SWMX_CAPTURE-<n>.swc for swmx_replay. Captures are written
+ * from the audio thread, so this is for reproducing bugs, not for sessions.
+ */
+
+#include "swmx_lv2.h"
+
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <lv2/core/lv2.h>
+#include <lv2/midi/midi.h>
+#include <lv2/urid/urid.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+struct SwmxLv2 {
+    SwmxInstance inst;
+    LV2_URID     midiEvent;
+
+    const float*             audioIn[SWMX_LV2_NUM_INPUTS];
+    float*                   audioOut[SWMX_LV2_NUM_OUTPUTS];
+    const LV2_Atom_Sequence* midiIn;
+    float*                   latency;
+    std::vector<const float*> params;
+
+    // Frames gathered into the bus buffer for the next step(), and the
+    // outputs of the previous step() being played out meanwhile
+    int   fill;
+    float outFifo[SWMX_LV2_NUM_OUTPUTS][SWMX_LV2_BLOCK];
+};
+
+static LV2_Handle instantiate(const LV2_Descriptor*, double rate, const char*,
+                              const LV2_Feature* const* features) {
+    const LV2_URID_Map* map = nullptr;
+    for (int i = 0; features[i]; ++i) {
+        if (!strcmp(features[i]->URI, LV2_URID__map)) {
+            map = static_cast<const LV2_URID_Map*>(features[i]->data);
+        }
+    }
+    if (!map) {
+        return nullptr;
+    }
+
+    ntHostSetGlobals((uint32_t)rate, SWMX_LV2_BLOCK);
+
+    std::vector<int32_t> specs(ntHostFactory()->numSpecifications);
+    swmxLv2Specs(specs.data());
+    SwmxLv2* self = new (std::nothrow) SwmxLv2();
+    if (!self || !self->inst.init(specs.data())) {
+        delete self;
+        return nullptr;
+    }
+    self->midiEvent = map->map(map->handle, LV2_MIDI__MidiEvent);
+    self->params.assign(self->inst.numParameters(), nullptr);
+
+    if (const char* capture = getenv("SWMX_CAPTURE")) {
+        static std::atomic<int> numCaptures{0};
+        char path[4096];
+        snprintf(path, sizeof(path), "%s-%d.swc", capture, numCaptures++);
+        self->inst.startCapture(path);  // best effort: run on regardless
+    }
+    return self;
+}
+
+static void connectPort(LV2_Handle h, uint32_t port, void* data) {
+    SwmxLv2* self = static_cast<SwmxLv2*>(h);
+    if (port < PORT_AUDIO_OUT) {
+        self->audioIn[port - PORT_AUDIO_IN] = static_cast<const float*>(data);
+    } else if (port < PORT_MIDI_IN) {
+        self->audioOut[port - PORT_AUDIO_OUT] = static_cast<float*>(data);
+    } else if (port == PORT_MIDI_IN) {
+        self->midiIn = static_cast<const LV2_Atom_Sequence*>(data);
+    } else if (port == PORT_LATENCY) {
+        self->latency = static_cast<float*>(data);
+    } else if (port - PORT_PARAM0 < self->params.size()) {
+        self->params[port - PORT_PARAM0] = static_cast<const float*>(data);
+    }
+}
+
+static void activate(LV2_Handle h) {
+    SwmxLv2* self = static_cast<SwmxLv2*>(h);
+    self->fill = 0;
+    memset(self->outFifo, 0, sizeof(self->outFifo));
+    memset(self->inst.busFrames(), 0, NT_HOST_NUM_BUSSES * SWMX_LV2_BLOCK * sizeof(float));
+}
+
+// Moves `count` host frames through the block FIFO, stepping when it fills
+static void runFrames(SwmxLv2* self, uint32_t offset, uint32_t count) {
+    float* busses = self->inst.busFrames();
+    while (count > 0) {
+        const uint32_t n = std::min<uint32_t>(count, SWMX_LV2_BLOCK - self->fill);
+        for (int i = 0; i < SWMX_LV2_NUM_INPUTS; ++i) {
+            float* dst = busses + i * SWMX_LV2_BLOCK + self->fill;
+            if (self->audioIn[i]) {
+                memcpy(dst, self->audioIn[i] + offset, n * sizeof(float));
+            } else {
+                memset(dst, 0, n * sizeof(float));
+            }
+        }
+        for (int o = 0; o < SWMX_LV2_NUM_OUTPUTS; ++o) {
+            if (self->audioOut[o]) {
+                memcpy(self->audioOut[o] + offset, self->outFifo[o] + self->fill, n * sizeof(float));
+            }
+        }
+        self->fill += n;
+        offset     += n;
+        count      -= n;
+
+        if (self->fill == SWMX_LV2_BLOCK) {
+            self->inst.step(SWMX_LV2_BLOCK);
+            for (int o = 0; o < SWMX_LV2_NUM_OUTPUTS; ++o) {
+                memcpy(self->outFifo[o],
+                       busses + (SWMX_LV2_FIRST_OUTPUT - 1 + o) * SWMX_LV2_BLOCK,
+                       sizeof(self->outFifo[o]));
+            }
+            // Nothing upstream writes the busses, so start each block silent
+            memset(busses, 0, NT_HOST_NUM_BUSSES * SWMX_LV2_BLOCK * sizeof(float));
+            self->fill = 0;
+        }
+    }
+}
+
+static void run(LV2_Handle h, uint32_t sampleCount) {
+    SwmxLv2* self = static_cast<SwmxLv2*>(h);
+
+    for (int p = 0; p < self->inst.numParameters(); ++p) {
+        if (self->params[p]) {
+            self->inst.setValue(p, (int16_t)std::lround(*self->params[p]));
+        }
+    }
+    if (self->latency) {
+        *self->latency = (float)SWMX_LV2_BLOCK;
+    }
+
+    // MIDI lands between frames and takes effect at the next step, as on the module
+    uint32_t pos = 0;
+    if (self->midiIn) {
+        LV2_ATOM_SEQUENCE_FOREACH(self->midiIn, ev) {
+            if (ev->body.type != self->midiEvent || ev->body.size < 3) {
+                continue;
+            }
+            const uint32_t at = std::min<uint32_t>((uint32_t)ev->time.frames, sampleCount);
+            runFrames(self, pos, at - pos);
+            pos = at;
+            const uint8_t* msg = reinterpret_cast<const uint8_t*>(ev + 1);
+            self->inst.midiMessage(msg[0], msg[1], msg[2]);
+        }
+    }
+    runFrames(self, pos, sampleCount - pos);
+}
+
+static void cleanup(LV2_Handle h) {
+    delete static_cast<SwmxLv2*>(h);
+}
+
+static const LV2_Descriptor gDescriptor = {
+    SWMX_LV2_URI,
+    instantiate,
+    connectPort,
+    activate,
+    run,
+    nullptr,
+    cleanup,
+    nullptr
+};
+
+extern "C" LV2_SYMBOL_EXPORT const LV2_Descriptor* lv2_descriptor(uint32_t index) {
+    return (index == 0) ? &gDescriptor : nullptr;
+}
@@ -0,0 +1,54 @@
+/*
+ * LV2 wrapper for the Switching Mixer (SwMx) - shared by the plugin and the
+ * TTL generator so the port list always matches the compiled algorithm.
+ */
+
+#pragma once
+
+#include "nt_host.h"
+
+#define SWMX_LV2_URI "https://github.com/kuttor/SwitchingMixer#lv2"
+
+// Frames per step(). The wrapper buffers one block, so this is also the
+// reported latency. Must be a multiple of 4.
+#ifndef SWMX_LV2_BLOCK
+#define SWMX_LV2_BLOCK 16
+#endif
+static_assert(SWMX_LV2_BLOCK % 4 == 0, "step() works on multiples of 4 frames");
+
+// Physical jacks of the module: busses 1-12 are inputs, 13-20 outputs
+constexpr int SWMX_LV2_NUM_INPUTS   = 12;
+constexpr int SWMX_LV2_NUM_OUTPUTS  = 8;
+constexpr int SWMX_LV2_FIRST_OUTPUT = 13;
+
+enum SwmxLv2Port {
+    PORT_AUDIO_IN  = 0,
+    PORT_AUDIO_OUT = PORT_AUDIO_IN + SWMX_LV2_NUM_INPUTS,
+    PORT_MIDI_IN   = PORT_AUDIO_OUT + SWMX_LV2_NUM_OUTPUTS,
+    PORT_LATENCY,
+    PORT_PARAM0    // One control port per algorithm parameter
+};
+
+// The TTL is static, so the bundle is built for fixed specifications:
+// factory defaults with these overrides (the largest routing layout, with
+// every optional feature block).
+static inline void swmxLv2Specs(int32_t* specs) {
+    ntHostDefaultSpecs(specs);
+    static const struct { const char* name; int32_t value; } overrides[] = {
+        { "Groups",       4 },
+        { "Destinations", 4 },
+        { "Ducking",      1 },
+        { "Envelope",     1 },
+        { "Modulation",   1 },
+        { "Ctrl Options", 1 },
+        { "Aux Send",     1 },
+        { "Mid/Side",     1 },
+        { "Fade Options", 1 },
+    };
+    for (const auto& o : overrides) {
+        const int i = ntHostFindSpec(o.name);
+        if (i >= 0) {
+            specs[i] = o.value;
+        }
+    }
+}
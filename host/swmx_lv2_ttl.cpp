@@ -0,0 +1,144 @@
+/*
+ * Writes manifest.ttl and swmx.ttl for the SwMx LV2 bundle.
+ * Ports are generated from the algorithm's own parameter table, so names,
+ * ranges, defaults and enum labels always match SwitchingMixer.cpp.
+ *
+ * Usage: swmx_lv2_ttl <bundle dir>
+ */
+
+#include "swmx_lv2.h"
+
+#include <cstdio>
+#include <string>
+
+static void writeManifest(FILE* f, const SwmxInstance&) {
+    fprintf(f,
+        "@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .\n"
+        "@prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .\n"
+        "\n"
+        "<" SWMX_LV2_URI ">\n"
+        "    a lv2:Plugin ;\n"
+        "    lv2:binary <swmx.so> ;\n"
+        "    rdfs:seeAlso <swmx.ttl> .\n");
+}
+
+static void writePorts(FILE* f, const SwmxInstance& inst) {
+    for (int i = 0; i < SWMX_LV2_NUM_INPUTS; ++i) {
+        fprintf(f,
+            "    lv2:port [\n"
+            "        a lv2:AudioPort, lv2:InputPort ;\n"
+            "        lv2:index %d ;\n"
+            "        lv2:symbol \"in%d\" ;\n"
+            "        lv2:name \"Input %d\"\n"
+            "    ] ;\n", PORT_AUDIO_IN + i, i + 1, i + 1);
+    }
+    for (int o = 0; o < SWMX_LV2_NUM_OUTPUTS; ++o) {
+        fprintf(f,
+            "    lv2:port [\n"
+            "        a lv2:AudioPort, lv2:OutputPort ;\n"
+            "        lv2:index %d ;\n"
+            "        lv2:symbol \"out%d\" ;\n"
+            "        lv2:name \"Output %d\"\n"
+            "    ] ;\n", PORT_AUDIO_OUT + o, o + 1, o + 1);
+    }
+    fprintf(f,
+        "    lv2:port [\n"
+        "        a lv2:InputPort, atom:AtomPort ;\n"
+        "        atom:bufferType atom:Sequence ;\n"
+        "        atom:supports midi:MidiEvent ;\n"
+        "        lv2:designation lv2:control ;\n"
+        "        lv2:index %d ;\n"
+        "        lv2:symbol \"midi_in\" ;\n"
+        "        lv2:name \"MIDI In\"\n"
+        "    ] ;\n"
+        "    lv2:port [\n"
+        "        a lv2:ControlPort, lv2:OutputPort ;\n"
+        "        lv2:index %d ;\n"
+        "        lv2:symbol \"latency\" ;\n"
+        "        lv2:name \"Latency\" ;\n"
+        "        lv2:designation lv2:latency ;\n"
+        "        lv2:portProperty lv2:reportsLatency, lv2:integer ;\n"
+        "        lv2:minimum 0 ;\n"
+        "        lv2:maximum %d\n"
+        "    ]", PORT_MIDI_IN, PORT_LATENCY, SWMX_LV2_BLOCK);
+
+    for (int p = 0; p < inst.numParameters(); ++p) {
+        const _NT_parameter& param = inst.parameter(p);
+        char name[64];
+        inst.parameterName(p, name, sizeof(name));
+        fprintf(f,
+            " ;\n"
+            "    lv2:port [\n"
+            "        a lv2:ControlPort, lv2:InputPort ;\n"
+            "        lv2:index %d ;\n"
+            "        lv2:symbol \"p%d\" ;\n"
+            "        lv2:name \"%s\" ;\n"
+            "        lv2:default %d ;\n"
+            "        lv2:minimum %d ;\n"
+            "        lv2:maximum %d ;\n",
+            PORT_PARAM0 + p, p, name, param.def, param.min, param.max);
+        if (param.unit == kNT_unitEnum && param.enumStrings) {
+            fprintf(f, "        lv2:portProperty lv2:integer, lv2:enumeration");
+            for (int v = param.min; v <= param.max && param.enumStrings[v - param.min]; ++v) {
+                fprintf(f, " ;\n        lv2:scalePoint [ rdfs:label \"%s\" ; rdf:value %d ]",
+                        param.enumStrings[v - param.min], v);
+            }
+            fprintf(f, "\n    ]");
+        } else {
+            fprintf(f, "        lv2:portProperty lv2:integer\n    ]");
+        }
+    }
+    fprintf(f, " .\n");
+}
+
+static void writePlugin(FILE* f, const SwmxInstance& inst) {
+    fprintf(f,
+        "@prefix atom: <http://lv2plug.in/ns/ext/atom#> .\n"
+        "@prefix doap: <http://usefulinc.com/ns/doap#> .\n"
+        "@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .\n"
+        "@prefix midi: <http://lv2plug.in/ns/ext/midi#> .\n"
+        "@prefix rdf:  <http://www.w3.org/1999/02/22-rdf-syntax-ns#> .\n"
+        "@prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .\n"
+        "@prefix urid: <http://lv2plug.in/ns/ext/urid#> .\n"
+        "\n"
+        "<" SWMX_LV2_URI ">\n"
+        "    a lv2:Plugin, lv2:MixerPlugin ;\n"
+        "    doap:name \"Switching Mixer (SwMx)\" ;\n"
+        "    doap:license <http://opensource.org/licenses/MIT> ;\n"
+        "    lv2:requiredFeature urid:map ;\n"
+        "    lv2:optionalFeature lv2:hardRTCapable ;\n");
+    writePorts(f, inst);
+}
+
+static bool writeFile(const std::string& path, void (*writer)(FILE*, const SwmxInstance&),
+                      const SwmxInstance& inst) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) {
+        fprintf(stderr, "swmx_lv2_ttl: cannot write %s\n", path.c_str());
+        return false;
+    }
+    writer(f, inst);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: swmx_lv2_ttl <bundle dir>\n");
+        return 2;
+    }
+    ntHostSetGlobals(48000, SWMX_LV2_BLOCK);
+
+    std::vector<int32_t> specs(ntHostFactory()->numSpecifications);
+    swmxLv2Specs(specs.data());
+    SwmxInstance inst;
+    if (!inst.init(specs.data())) {
+        fprintf(stderr, "swmx_lv2_ttl: specifications rejected\n");
+        return 1;
+    }
+
+    const std::string dir = argv[1];
+    const bool ok = writeFile(dir + "/manifest.ttl", writeManifest, inst)
+                 && writeFile(dir + "/swmx.ttl", writePlugin, inst);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,521 @@
+/*
+ * Offline batch renderer for the Switching Mixer (SwMx).
+ * Renders WAV files, optionally across parameter sweeps, through independent
+ * SwMx instances on every core. Jobs are spread over per-worker lanes of a
+ * work-stealing queue; each worker owns its instance, bus buffer and output
+ * buffer, so nothing mutable is shared beyond the queue and two counters.
+ *
+ * Usage: swmx_render [options] input.wav...
+ *   -o DIR          output directory (default: .)
+ *   -j N            worker threads (default: all cores)
+ *   -b FRAMES       frames per step(), multiple of 4 (default: 128)
+ *   -S NAME=VALUE   specification, e.g. -S Groups=2
+ *   -p PARAM=VALUE  parameter value; PARAM is an index or a name such as
+ *                   "Bypass" or "2:Volume"
+ *   -s PARAM=A:B[:STEP]
+ *                   sweep a parameter from A to B; several sweeps render
+ *                   every combination
+ *   -r RATE         sample rate for raw streams (default: 48000)
+ *   -c CHANNELS     channels per frame of a raw input stream (default: 2)
+ *   -a FILE         MIDI, parameter and CV automation for every render: a
+ *                   Standard MIDI File or .swa file (see automation.h)
+ *   -C DIR          capture each render's session into DIR/<output>.swc
+ *                   (DIR/stream.swc for a pipeline) for swmx_replay
+ *
+ * WAV channels 1-12 feed busses 1-12; busses 13-20 are written as an
+ * 8-channel 32-bit float WAV named <input>[_p<index>-<value>...].wav, where
+ * <input> is the input's file name without its extension (so input names
+ * must be unique across directories).
+ * WAV inputs are memory-mapped and decoded directly into the bus layout.
+ *
+ * With "-" as the only input, SwMx runs as a pipeline filter instead:
+ * interleaved native-endian float32 frames are read from stdin and the
+ * 8 output busses are written to stdout in the same format.
+ *
+ * Automation events are applied between steps, at the step boundary
+ * within 4 frames of their timestamp; blocks are cut short so that boundary
+ * exists. CV events hold their level on a bus, replacing its input.
+ */
+
+#include "automation.h"
+#include "nt_host.h"
+#include "wav_file.h"
+#include "work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static const int RENDER_NUM_INPUTS   = 12;
+static const int RENDER_FIRST_OUTPUT = 13;
+static const int RENDER_NUM_OUTPUTS  = 8;
+
+struct ParamSetting {
+    int     param;
+    int16_t value;
+};
+
+struct ParamSweep {
+    int     param;
+    int16_t from, to, stepSize;
+};
+
+struct RenderJob {
+    std::string               input;
+    std::string               output;
+    std::vector<ParamSetting> settings;
+};
+
+struct RenderConfig {
+    std::vector<int32_t>      specs;
+    std::vector<ParamSetting> settings;
+    int                       blockFrames = 128;
+    uint32_t                  rawRate = 48000;
+    int                       rawChannels = 2;
+    std::vector<AutomationEvent> automation;
+    std::string               captureDir;  // empty = no capture
+};
+
+// Totals across workers, for the throughput report
+struct RenderStats {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<int>      failed{0};
+};
+
+static void usage() {
+    fprintf(stderr,
+        "usage: swmx_render [-o DIR] [-j N] [-b FRAMES] [-a FILE] [-C DIR] [-S NAME=VALUE]...\n"
+        "                   [-p PARAM=VALUE]... [-s PARAM=A:B[:STEP]]... input.wav...\n"
+        "       swmx_render [-b FRAMES] [-r RATE] [-c CHANNELS] [-a FILE] [-C DIR] [-S NAME=VALUE]...\n"
+        "                   [-p PARAM=VALUE]... - < in.raw > out.raw\n");
+}
+
+/* ───── argument parsing ───── */
+static bool splitAssign(const char* arg, std::string& name, std::string& value) {
+    const char* eq = strrchr(arg, '=');
+    if (!eq || eq == arg) {
+        return false;
+    }
+    name.assign(arg, eq - arg);
+    value.assign(eq + 1);
+    return true;
+}
+
+static bool parseInt(const std::string& s, long& out) {
+    char* end = nullptr;
+    out = strtol(s.c_str(), &end, 10);
+    return !s.empty() && *end == '\0';
+}
+
+// Parameter index from a number or a display name ("Bypass", "2:Volume")
+static int findParam(const SwmxInstance& inst, const std::string& name) {
+    long index;
+    if (parseInt(name, index)) {
+        return (index >= 0 && index < inst.numParameters()) ? (int)index : -1;
+    }
+    char display[64];
+    for (int p = 0; p < inst.numParameters(); ++p) {
+        inst.parameterName(p, display, sizeof(display));
+        if (name == display) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+static std::string outputStem(const std::string& input) {
+    size_t slash = input.find_last_of('/');
+    std::string base = (slash == std::string::npos) ? input : input.substr(slash + 1);
+    size_t dot = base.find_last_of('.');
+    return (dot == std::string::npos || dot == 0) ? base : base.substr(0, dot);
+}
+
+// Steps the sweep values like an odometer; false once every sweep has wrapped
+static bool nextCombination(std::vector<int16_t>& at, const std::vector<ParamSweep>& sweeps) {
+    for (size_t i = sweeps.size(); i-- > 0;) {
+        if (at[i] + sweeps[i].stepSize <= sweeps[i].to) {
+            at[i] = (int16_t)(at[i] + sweeps[i].stepSize);
+            return true;
+        }
+        at[i] = sweeps[i].from;
+    }
+    return false;
+}
+
+// One job per input per sweep combination. Outputs are named by the input's
+// stem alone, so inputs sharing a stem (a/x.wav, b/x.wav) would overwrite
+// each other's renders and captures; those are rejected.
+static bool buildJobs(const std::vector<std::string>& inputs, const std::vector<ParamSweep>& sweeps,
+                      const std::string& outDir, std::vector<RenderJob>& jobs, std::string& err) {
+    std::unordered_map<std::string, const std::string*> stems;
+    for (const std::string& input : inputs) {
+        const auto seen = stems.emplace(outputStem(input), &input);
+        if (!seen.second) {
+            err = *seen.first->second + " and " + input + " both render to "
+                + outDir + "/" + seen.first->first + "*.wav";
+            return false;
+        }
+    }
+    for (const std::string& input : inputs) {
+        std::vector<int16_t> at(sweeps.size());
+        for (size_t i = 0; i < sweeps.size(); ++i) {
+            at[i] = sweeps[i].from;
+        }
+        do {
+            RenderJob job;
+            job.input  = input;
+            job.output = outDir + "/" + outputStem(input);
+            for (size_t i = 0; i < sweeps.size(); ++i) {
+                job.settings.push_back({ sweeps[i].param, at[i] });
+                job.output += "_p" + std::to_string(sweeps[i].param) + "-" + std::to_string(at[i]);
+            }
+            job.output += ".wav";
+            jobs.push_back(job);
+        } while (nextCombination(at, sweeps));
+    }
+    return true;
+}
+
+/* ───── rendering ───── */
+struct RenderWorker {
+    SwmxInstance       inst;
+    std::vector<float> inFrames;   // raw streams only
+    std::vector<float> outFrames;  // interleaved output, reused every block
+    uint32_t           cvMask;     // busses held by AUTO_CV events
+    float              cvVolts[NT_HOST_NUM_BUSSES];
+};
+
+// capturePath is empty unless the session is being captured
+static bool startInstance(RenderWorker& w, const RenderConfig& cfg,
+                          const std::vector<ParamSetting>& jobSettings,
+                          const std::string& capturePath, std::string& err) {
+    if (!w.inst.init(cfg.specs.data())) {
+        err = "specifications rejected";
+        return false;
+    }
+    if (!capturePath.empty() && !w.inst.startCapture(capturePath.c_str())) {
+        err = "can't create " + capturePath;
+        return false;
+    }
+    for (const ParamSetting& s : cfg.settings) {
+        w.inst.setValue(s.param, s.value);
+    }
+    for (const ParamSetting& s : jobSettings) {
+        w.inst.setValue(s.param, s.value);
+    }
+    w.outFrames.resize((size_t)cfg.blockFrames * RENDER_NUM_OUTPUTS);
+    w.cvMask = 0;
+    return true;
+}
+
+// Applies the events due at the step starting at `pos` and returns that
+// step's length: B, or less so the next event falls on a step boundary
+static int dispatchEvents(RenderWorker& w, AutomationCursor& cursor, uint64_t pos, int B) {
+    while (const AutomationEvent* e = cursor.due(pos + 4)) {
+        if (e->type == AUTO_MIDI) {
+            w.inst.midiMessage(e->midi[0], e->midi[1], e->midi[2]);
+        } else if (e->type == AUTO_PARAM) {
+            if (e->target < w.inst.numParameters()) {
+                w.inst.setValue(e->target, e->value);
+            }
+        } else if (e->target >= 1 && e->target <= NT_HOST_NUM_BUSSES) {
+            w.cvMask |= 1u << (e->target - 1);
+            w.cvVolts[e->target - 1] = e->volts;
+        }
+    }
+    const uint64_t next = cursor.nextFrame();
+    return (next < pos + B) ? (int)((next - pos) & ~3ull) : B;
+}
+
+static void applyCv(RenderWorker& w, int stepFrames) {
+    float* busses = w.inst.busFrames();
+    for (uint32_t m = w.cvMask; m; m &= m - 1) {
+        const int b = __builtin_ctz(m);
+        std::fill(busses + b * stepFrames, busses + (b + 1) * stepFrames, w.cvVolts[b]);
+    }
+}
+
+// Runs step() on busses already holding stepFrames of input, then
+// interleaves the first n frames of the output busses into w.outFrames
+static void stepBlock(RenderWorker& w, int stepFrames, int n) {
+    w.inst.step(stepFrames);
+    const float* outBus = w.inst.busFrames() + (RENDER_FIRST_OUTPUT - 1) * stepFrames;
+    for (int o = 0; o < RENDER_NUM_OUTPUTS; ++o) {
+        for (int i = 0; i < n; ++i) {
+            w.outFrames[i * RENDER_NUM_OUTPUTS + o] = outBus[o * stepFrames + i];
+        }
+    }
+}
+
+static bool renderJob(RenderWorker& w, const RenderConfig& cfg, const RenderJob& job,
+                      RenderStats& stats, std::string& err) {
+    WavReader in;
+    if (!in.open(job.input.c_str(), err)) {
+        return false;
+    }
+    if (in.sampleRate() != ntHostSampleRate()) {
+        err = "sample rate " + std::to_string(in.sampleRate()) + " differs from "
+            + std::to_string(ntHostSampleRate());
+        return false;
+    }
+
+    // A fresh algorithm per job keeps renders independent of job order;
+    // the instance's vectors keep their capacity between jobs
+    const std::string capturePath = cfg.captureDir.empty() ? std::string()
+        : cfg.captureDir + "/" + outputStem(job.output) + ".swc";
+    if (!startInstance(w, cfg, job.settings, capturePath, err)) {
+        return false;
+    }
+
+    WavWriter out;
+    if (!out.open(job.output.c_str(), RENDER_NUM_OUTPUTS, in.sampleRate())) {
+        err = "can't create " + job.output;
+        return false;
+    }
+
+    AutomationCursor cursor(cfg.automation);
+    float* busses = w.inst.busFrames();
+    for (uint64_t pos = 0; pos < in.frames();) {
+        const int len = dispatchEvents(w, cursor, pos, cfg.blockFrames);
+        const int n = (int)std::min<uint64_t>(len, in.frames() - pos);
+        const int stepFrames = (n + 3) & ~3;  // the tail block is padded with silence
+
+        std::fill(busses, busses + NT_HOST_NUM_BUSSES * stepFrames, 0.0f);
+        in.read(pos, stepFrames, busses, stepFrames, RENDER_NUM_INPUTS);
+        applyCv(w, stepFrames);
+        stepBlock(w, stepFrames, n);
+        pos += n;
+        out.write(w.outFrames.data(), n);
+    }
+    if (!out.close()) {
+        err = "write failed for " + job.output;
+        return false;
+    }
+    if (!w.inst.stopCapture()) {
+        err = "write failed for " + capturePath;
+        return false;
+    }
+    stats.frames += in.frames();
+    return true;
+}
+
+// Pipeline filter: float32 frames from stdin through one instance to stdout
+static int renderStream(const RenderConfig& cfg) {
+    RenderWorker w;
+    const std::string capturePath = cfg.captureDir.empty() ? std::string()
+        : cfg.captureDir + "/stream.swc";
+    std::string err;
+    if (!startInstance(w, cfg, std::vector<ParamSetting>(), capturePath, err)) {
+        fprintf(stderr, "swmx_render: %s\n", err.c_str());
+        return 2;
+    }
+    const int B  = cfg.blockFrames;
+    const int ch = cfg.rawChannels;
+    const int used = std::min(ch, RENDER_NUM_INPUTS);
+    w.inFrames.resize((size_t)B * ch);
+    float* busses = w.inst.busFrames();
+    AutomationCursor cursor(cfg.automation);
+
+    for (uint64_t pos = 0;; ) {
+        // Whole frames only; a trailing partial frame is dropped
+        const int len = dispatchEvents(w, cursor, pos, B);
+        const int n = (int)(fread(w.inFrames.data(), sizeof(float) * ch, len, stdin));
+        if (n == 0) {
+            break;
+        }
+        pos += n;
+        const int stepFrames = (n + 3) & ~3;
+        std::fill(busses, busses + NT_HOST_NUM_BUSSES * stepFrames, 0.0f);
+        for (int c = 0; c < used; ++c) {
+            float* dst = busses + c * stepFrames;
+            for (int i = 0; i < n; ++i) {
+                dst[i] = w.inFrames[i * ch + c];
+            }
+        }
+        applyCv(w, stepFrames);
+        stepBlock(w, stepFrames, n);
+        if (fwrite(w.outFrames.data(), sizeof(float) * RENDER_NUM_OUTPUTS, n, stdout) != (size_t)n) {
+            fprintf(stderr, "swmx_render: write to stdout failed\n");
+            return 1;
+        }
+        if (n < len) {
+            break;
+        }
+    }
+    if (ferror(stdin)) {
+        fprintf(stderr, "swmx_render: read from stdin failed\n");
+        return 1;
+    }
+    if (!w.inst.stopCapture()) {
+        fprintf(stderr, "swmx_render: write failed for %s\n", capturePath.c_str());
+        return 1;
+    }
+    return fflush(stdout) == 0 ? 0 : 1;
+}
+
+static void workerMain(int id, WorkStealingQueue& queue, const RenderConfig& cfg,
+                       const std::vector<RenderJob>& jobs, RenderStats& stats) {
+    RenderWorker w;
+    size_t j;
+    while (queue.pop(id, j)) {
+        std::string err;
+        if (!renderJob(w, cfg, jobs[j], stats, err)) {
+            fprintf(stderr, "swmx_render: %s: %s\n", jobs[j].input.c_str(), err.c_str());
+            ++stats.failed;
+        }
+    }
+}
+
+/* ───── main ───── */
+int main(int argc, char** argv) {
+    std::string outDir = ".";
+    int numThreads = (int)std::thread::hardware_concurrency();
+    RenderConfig cfg;
+    cfg.specs.resize(ntHostFactory()->numSpecifications);
+    ntHostDefaultSpecs(cfg.specs.data());
+
+    std::vector<std::pair<std::string, std::string>> paramArgs, sweepArgs;
+    std::vector<std::string> inputs;
+    const char* automationPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a.size() == 2 && a[0] == '-' && i + 1 < argc) {
+            const char* v = argv[++i];
+            std::string name, value;
+            long n;
+            switch (a[1]) {
+                case 'o': outDir = v; continue;
+                case 'j': numThreads = atoi(v); continue;
+                case 'b': cfg.blockFrames = atoi(v); continue;
+                case 'r': cfg.rawRate = (uint32_t)atoi(v); continue;
+                case 'c': cfg.rawChannels = atoi(v); continue;
+                case 'a': automationPath = v; continue;
+                case 'C': cfg.captureDir = v; continue;
+                case 'S': {
+                    const int s = splitAssign(v, name, value) ? ntHostFindSpec(name.c_str()) : -1;
+                    if (s < 0 || !parseInt(value, n)) {
+                        fprintf(stderr, "swmx_render: bad specification '%s'\n", v);
+                        return 2;
+                    }
+                    cfg.specs[s] = (int32_t)n;
+                    continue;
+                }
+                case 'p':
+                case 's':
+                    if (!splitAssign(v, name, value)) {
+                        fprintf(stderr, "swmx_render: expected PARAM=VALUE, got '%s'\n", v);
+                        return 2;
+                    }
+                    (a[1] == 'p' ? paramArgs : sweepArgs).emplace_back(name, value);
+                    continue;
+                default:
+                    break;
+            }
+        }
+        if (a[0] == '-' && a != "-") {
+            usage();
+            return 2;
+        }
+        inputs.push_back(a);
+    }
+    const bool stream = (inputs.size() == 1 && inputs[0] == "-");
+    if (inputs.empty() || numThreads < 1 || cfg.blockFrames < 4 || cfg.blockFrames % 4 != 0
+        || (stream && (cfg.rawRate == 0 || cfg.rawChannels < 1 || !sweepArgs.empty()))) {
+        usage();
+        return 2;
+    }
+
+    // All instances share NT_globals, so the first input sets the rate
+    if (stream) {
+        ntHostSetGlobals(cfg.rawRate, (uint32_t)cfg.blockFrames);
+    } else {
+        WavReader first;
+        std::string err;
+        if (!first.open(inputs[0].c_str(), err)) {
+            fprintf(stderr, "swmx_render: %s: %s\n", inputs[0].c_str(), err.c_str());
+            return 1;
+        }
+        ntHostSetGlobals(first.sampleRate(), (uint32_t)cfg.blockFrames);
+    }
+    if (automationPath) {
+        std::string err;
+        if (!automationLoad(automationPath, ntHostSampleRate(), cfg.automation, err)) {
+            fprintf(stderr, "swmx_render: %s: %s\n", automationPath, err.c_str());
+            return 1;
+        }
+    }
+
+    // A probe instance resolves parameter names against the chosen specs
+    SwmxInstance probe;
+    if (!probe.init(cfg.specs.data())) {
+        fprintf(stderr, "swmx_render: specifications rejected\n");
+        return 2;
+    }
+    for (const auto& pa : paramArgs) {
+        const int p = findParam(probe, pa.first);
+        long n;
+        if (p < 0 || !parseInt(pa.second, n)) {
+            fprintf(stderr, "swmx_render: bad parameter '%s=%s'\n", pa.first.c_str(), pa.second.c_str());
+            return 2;
+        }
+        cfg.settings.push_back({ p, (int16_t)n });
+    }
+    std::vector<ParamSweep> sweeps;
+    for (const auto& sa : sweepArgs) {
+        const int p = findParam(probe, sa.first);
+        long from = 0, to = 0, stepSize = 1;
+        const std::string& r = sa.second;
+        const size_t c1 = r.find(':');
+        const size_t c2 = (c1 == std::string::npos) ? c1 : r.find(':', c1 + 1);
+        const bool ok = p >= 0 && c1 != std::string::npos
+                     && parseInt(r.substr(0, c1), from)
+                     && parseInt(r.substr(c1 + 1, c2 == std::string::npos ? c2 : c2 - c1 - 1), to)
+                     && (c2 == std::string::npos || parseInt(r.substr(c2 + 1), stepSize));
+        if (!ok || to < from || stepSize < 1) {
+            fprintf(stderr, "swmx_render: bad sweep '%s=%s'\n", sa.first.c_str(), r.c_str());
+            return 2;
+        }
+        sweeps.push_back({ p, (int16_t)from, (int16_t)to, (int16_t)stepSize });
+    }
+    if (stream) {
+        return renderStream(cfg);
+    }
+
+    std::vector<RenderJob> jobs;
+    std::string err;
+    if (!buildJobs(inputs, sweeps, outDir, jobs, err)) {
+        fprintf(stderr, "swmx_render: %s\n", err.c_str());
+        return 2;
+    }
+    numThreads = std::min<int>(numThreads, (int)jobs.size());
+
+    WorkStealingQueue queue(numThreads);
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        queue.push((int)(j % numThreads), j);
+    }
+
+    RenderStats stats;
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t) {
+        workers.emplace_back(workerMain, t, std::ref(queue), std::cref(cfg), std::cref(jobs),
+                             std::ref(stats));
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    const double wall  = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double audio = (double)stats.frames / ntHostSampleRate();
+
+    fprintf(stderr, "swmx_render: %zu jobs (%d failed) on %d threads: %.1f s of audio in %.2f s, %.1fx real-time\n",
+            jobs.size(), stats.failed.load(), numThreads, audio, wall, wall > 0.0 ? audio / wall : 0.0);
+    return stats.failed ? 1 : 0;
+}
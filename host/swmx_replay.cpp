@@ -0,0 +1,117 @@
+/*
+ * Re-runs a captured SwMx session (.swc, see capture.h) and checks that every
+ * step() leaves the busses exactly as it did when captured.
+ *
+ * Usage: swmx_replay [-n REPEAT] capture.swc
+ *   -n REPEAT   replay the session REPEAT times on fresh instances, e.g.
+ *               to give a profiler more samples (default: 1)
+ *
+ * Exits 1 at the first step whose output hash differs, reporting its block
+ * index and frame, so a debugger can break on that step.
+ */
+
+#include "capture.h"
+#include "nt_host.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct ReplayTotals {
+    uint64_t blocks = 0;
+    uint64_t frames = 0;
+    uint64_t params = 0;
+    uint64_t midi   = 0;
+};
+
+// One pass through the file; false on a malformed file or a mismatch
+static bool replayOnce(CaptureReader& reader, const CaptureHeader& header, ReplayTotals& totals,
+                       const char* path) {
+    SwmxInstance inst;
+    if (!inst.init(header.specs.data())) {
+        fprintf(stderr, "swmx_replay: %s: specifications rejected\n", path);
+        return false;
+    }
+    CaptureRecord rec;
+    std::string   err;
+    while (reader.next(rec, inst.busFrames(), NT_HOST_NUM_BUSSES, err)) {
+        if (rec.type == CAPTURE_PARAM) {
+            if (rec.param >= inst.numParameters()) {
+                fprintf(stderr, "swmx_replay: %s: parameter %u out of range\n", path, rec.param);
+                return false;
+            }
+            inst.setValue(rec.param, rec.value);
+            ++totals.params;
+        } else if (rec.type == CAPTURE_MIDI) {
+            inst.midiMessage(rec.midi[0], rec.midi[1], rec.midi[2]);
+            ++totals.midi;
+        } else {
+            NtHostCycleLog log = {};
+            memcpy(log.values, rec.cycles, rec.numCycles * sizeof(uint32_t));
+            log.count  = rec.numCycles;
+            log.replay = true;
+            ntHostSetCycleLog(&log);
+            inst.step(rec.numFrames);
+            ntHostSetCycleLog(nullptr);
+            if (captureHash(inst.busFrames(), NT_HOST_NUM_BUSSES, rec.numFrames) != rec.hash) {
+                fprintf(stderr, "swmx_replay: %s: output differs at block %llu (frame %llu)\n",
+                        path, (unsigned long long)totals.blocks, (unsigned long long)totals.frames);
+                return false;
+            }
+            ++totals.blocks;
+            totals.frames += rec.numFrames;
+        }
+    }
+    if (!err.empty()) {
+        fprintf(stderr, "swmx_replay: %s: %s\n", path, err.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int repeat = 1;
+    int arg = 1;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        repeat = atoi(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg != 1 || repeat < 1) {
+        fprintf(stderr, "usage: swmx_replay [-n REPEAT] capture.swc\n");
+        return 2;
+    }
+    const char* path = argv[arg];
+
+    CaptureReader reader;
+    CaptureHeader header;
+    std::string   err;
+    if (!reader.open(path, header, err)) {
+        fprintf(stderr, "swmx_replay: %s: %s\n", path, err.c_str());
+        return 1;
+    }
+    if (header.specs.size() != ntHostFactory()->numSpecifications) {
+        fprintf(stderr, "swmx_replay: %s: captured with %zu specifications, this build has %u\n",
+                path, header.specs.size(), ntHostFactory()->numSpecifications);
+        return 1;
+    }
+    ntHostSetGlobals(header.sampleRate, header.maxFrames);
+
+    ReplayTotals totals;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+        reader.rewind();
+        totals = ReplayTotals();
+        if (!replayOnce(reader, header, totals, path)) {
+            return 1;
+        }
+    }
+    const double wall  = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double audio = (double)totals.frames * repeat / header.sampleRate;
+
+    fprintf(stderr, "swmx_replay: %llu blocks, %llu parameter changes, %llu MIDI messages: bit-exact"
+            " (%.1f s of audio in %.2f s, %.1fx real-time)\n",
+            (unsigned long long)totals.blocks, (unsigned long long)totals.params,
+            (unsigned long long)totals.midi, audio, wall, wall > 0.0 ? audio / wall : 0.0);
+    return 0;
+}
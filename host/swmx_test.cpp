@@ -0,0 +1,813 @@
+/*
+ * Host-side regression tests for the Switching Mixer (SwMx).
+ * Each case drives instances through a scripted session, checks what they
+ * write to the busses, and captures the session (see capture.h) so CTest can
+ * re-run it bit-exactly with swmx_replay.
+ *
+ * Usage: swmx_test CASE capture.swc
+ *   capture_roundtrip  the capture holds every parameter change, MIDI
+ *                      message, step and cycle reading of a session
+ *   retrigger_wrap     a gesture loop wrapping mid-fade is not a retrigger:
+ *                      Fast Kill matches Chase until a real one
+ *   follower_leader    a follower group reproduces its leader's output, at
+ *                      full quality and with the governor holding gains
+ *   latency_shift      Dest Delay shifts a destination by exactly its samples
+ *   delay_reset        a delay ring restarts silent after a bypass or idle
+ *   arbitration        Control, MIDI and Active Dest resolve per Arbitration mode
+ *   array_duck         an array ducks over the whole bus run of a destination
+ *   zones              custom zone breakpoints select by CV and MIDI
+ *   clipping           Output Clip shapes the summed destination bus once
+ *                      and leaves unwritten busses alone
+ *   mid_side           the mid follows Active Dest and the side Side Dest,
+ *                      decoding back to stereo where they meet
+ *   fade_out           Fade times the rising destination and Fade Out the
+ *                      falling one
+ *
+ * Exits 1 with a message on the first failed check.
+ */
+
+#include "capture.h"
+#include "nt_host.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const uint32_t TEST_SAMPLE_RATE = 48000;
+static const int      TEST_FRAMES      = 128;
+
+static const char* gCase = "";
+
+static bool fail(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "swmx_test: %s: ", gCase);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    return false;
+}
+
+static float* bus(SwmxInstance& inst, int i) {
+    return inst.busFrames() + (i - 1) * TEST_FRAMES;
+}
+
+// Sets a parameter by display name ("Bypass", "2:Fade"); false if there is none
+static bool set(SwmxInstance& inst, const char* name, int16_t value) {
+    char display[64];
+    for (int p = 0; p < inst.numParameters(); ++p) {
+        inst.parameterName(p, display, sizeof(display));
+        if (!strcmp(display, name)) {
+            inst.setValue(p, value);
+            return true;
+        }
+    }
+    return fail("no parameter \"%s\"", name);
+}
+
+// Builds an instance from the default specs with the named ones overridden
+static bool init(SwmxInstance& inst, std::initializer_list<std::pair<const char*, int32_t>> specs) {
+    std::vector<int32_t> values(ntHostFactory()->numSpecifications);
+    ntHostDefaultSpecs(values.data());
+    for (const auto& s : specs) {
+        const int i = ntHostFindSpec(s.first);
+        if (i < 0) {
+            return fail("no specification \"%s\"", s.first);
+        }
+        values[i] = s.second;
+    }
+    return inst.init(values.data()) || fail("specifications rejected");
+}
+
+// Clears every bus, holds bus 1 at `in` and runs one block
+static void stepDC(SwmxInstance& inst, float in) {
+    std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+    std::fill(bus(inst, 1), bus(inst, 1) + TEST_FRAMES, in);
+    inst.step(TEST_FRAMES);
+}
+
+// Cycle counter for NT_getCpuCycleCount() that makes every block overrun any
+// CPU Budget, so the governor steps down deterministically
+static uint32_t gOverrunCycles = 0;
+
+static uint32_t overrunClock() {
+    return gOverrunCycles += 100000000;
+}
+
+/* ───── capture_roundtrip ───── */
+// A governed session switched by MIDI: reading the capture back must give one
+// record per parameter change, MIDI message and step, with the governor's
+// two cycle readings per step
+static bool testCaptureRoundtrip(const char* capturePath) {
+    const int BLOCKS = 200;
+    const int SWITCH = 20;  // blocks between MIDI CCs
+
+    SwmxInstance inst;
+    if (!init(inst, {}) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13)
+        && set(inst, "1:Dest 2 L", 15) && set(inst, "1:MIDI Enable", 1) && set(inst, "CPU Budget", 50);
+    if (!ok) {
+        return false;
+    }
+    const int params = 5;
+    ntHostSetCycleClock(overrunClock);
+    for (int b = 0; b < BLOCKS; ++b) {
+        if (b % SWITCH == 0) {
+            inst.midiMessage(0xB0, 0, (b / SWITCH) % 2 ? 127 : 0);
+        }
+        stepDC(inst, 1.0f);
+    }
+    ntHostSetCycleClock(nullptr);
+    if (!inst.stopCapture()) {
+        return fail("can't write %s", capturePath);
+    }
+
+    CaptureReader reader;
+    CaptureHeader header;
+    std::string   err;
+    if (!reader.open(capturePath, header, err)) {
+        return fail("%s: %s", capturePath, err.c_str());
+    }
+    if (header.sampleRate != TEST_SAMPLE_RATE || header.maxFrames != (uint32_t)TEST_FRAMES
+        || header.specs.size() != ntHostFactory()->numSpecifications) {
+        return fail("header doesn't match the session");
+    }
+    std::vector<float> busses(NT_HOST_NUM_BUSSES * TEST_FRAMES);
+    CaptureRecord rec;
+    int counts[3] = {};
+    while (reader.next(rec, busses.data(), NT_HOST_NUM_BUSSES, err)) {
+        ++counts[rec.type];
+        if (rec.type == CAPTURE_STEP && (rec.numFrames != TEST_FRAMES || rec.numCycles != 2)) {
+            return fail("step %d has %d frames and %d cycle readings", counts[CAPTURE_STEP],
+                        rec.numFrames, rec.numCycles);
+        }
+    }
+    if (!err.empty()) {
+        return fail("%s: %s", capturePath, err.c_str());
+    }
+    if (counts[CAPTURE_PARAM] != params || counts[CAPTURE_MIDI] != BLOCKS / SWITCH
+        || counts[CAPTURE_STEP] != BLOCKS) {
+        return fail("read %d parameter, %d MIDI and %d step records", counts[CAPTURE_PARAM],
+                    counts[CAPTURE_MIDI], counts[CAPTURE_STEP]);
+    }
+    return true;
+}
+
+/* ───── retrigger_wrap ───── */
+// Group 1 records 1 -> 2 -> 1 with the loop ending mid-fade. Re-applying
+// Dest 1 at the wrap must leave Dest 2's fade alone, so Fast Kill and Chase
+// stay bit-identical until the second pass moves to Dest 2 while Dest 1 is
+// still open.
+static bool retriggerSetup(SwmxInstance& inst, int retrigger, const char* capturePath) {
+    if (!init(inst, { { "Fade Options", 1 } }) || (capturePath && !inst.startCapture(capturePath))) {
+        return fail("setup failed");
+    }
+    return set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13)
+        && set(inst, "1:Dest 1 R", 14) && set(inst, "1:Dest 2 L", 15) && set(inst, "1:Dest 2 R", 16)
+        && set(inst, "1:Fade", 1) && set(inst, "1:Retrigger", retrigger);
+}
+
+static bool testRetriggerWrap(const char* capturePath) {
+    const int RECORD = 400;             // blocks; a Fade of 1 settles well within 4.6 s
+    const int TO_2   = RECORD + 150;
+    const int TO_1   = TO_2 + 3750;
+    const int STOP   = TO_1 + 150;      // Dest 2 still fading out
+    const int PLAY   = STOP + 2000;
+    const int WRAP   = PLAY + (STOP - RECORD);
+    const int KILL   = WRAP + (TO_2 - RECORD);  // second pass: 1 -> 2 mid-fade
+    const int END    = KILL + 50;
+
+    SwmxInstance chase, kill;
+    if (!retriggerSetup(chase, 0, nullptr) || !retriggerSetup(kill, 2, capturePath)) {
+        return false;
+    }
+    for (int b = 0; b < END; ++b) {
+        for (SwmxInstance* inst : { &chase, &kill }) {
+            if (b == RECORD) set(*inst, "1:Gesture", 1);
+            if (b == TO_2)   set(*inst, "1:Active Dest", 2);
+            if (b == TO_1)   set(*inst, "1:Active Dest", 1);
+            if (b == STOP)   set(*inst, "1:Gesture", 0);
+            if (b == PLAY)   set(*inst, "1:Gesture", 2);
+            stepDC(*inst, 1.0f);
+        }
+        if (b == WRAP && bus(kill, 15)[0] < 0.1f) {
+            return fail("Dest 2 is not mid-fade at the loop wrap (%g)", bus(kill, 15)[0]);
+        }
+        if (b < KILL
+            && memcmp(bus(chase, 13), bus(kill, 13), 4 * TEST_FRAMES * sizeof(float)) != 0) {
+            return fail("Fast Kill differs from Chase at block %d (loop wraps at %d)", b, WRAP);
+        }
+    }
+    // The second pass retriggers for real: Fast Kill closes Dest 1 within a block
+    const float last = bus(kill, 13)[TEST_FRAMES - 1];
+    if (last > 0.001f || bus(chase, 13)[TEST_FRAMES - 1] < 0.1f) {
+        return fail("Fast Kill did not kill the open destination (%g)", last);
+    }
+    return kill.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── follower_leader ───── */
+// Group 2 follows group 1 with the same input onto other busses, so its
+// output must match the leader's sample for sample, including once the
+// governor (driven by a clock that makes every block overrun) holds gains
+// flat per block.
+static bool testFollowerLeader(const char* capturePath) {
+    const int   SWITCH    = 100;   // blocks between destination changes, mid-fade
+    const int   GOVERNED  = 1000;
+    const int   END       = 2000;
+    const float TOLERANCE = 1e-6f;
+
+    SwmxInstance inst;
+    if (!init(inst, { { "Groups", 2 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13)
+        && set(inst, "1:Dest 1 R", 14) && set(inst, "1:Dest 2 L", 15) && set(inst, "1:Dest 2 R", 16)
+        && set(inst, "1:Fade", 1) && set(inst, "2:Input R", 0) && set(inst, "2:Dest 1 L", 17)
+        && set(inst, "2:Dest 1 R", 18) && set(inst, "2:Dest 2 L", 19) && set(inst, "2:Dest 2 R", 20)
+        && set(inst, "2:Follow Group", 1);
+    if (!ok) {
+        return false;
+    }
+    int held = 0;
+    float prev = 0.0f;
+    for (int b = 0; b < END; ++b) {
+        if (b % SWITCH == 0) {
+            set(inst, "1:Active Dest", (int16_t)(1 + (b / SWITCH) % 2));
+        }
+        if (b == GOVERNED) {
+            ntHostSetCycleClock(overrunClock);
+            set(inst, "CPU Budget", 50);
+        }
+        stepDC(inst, 1.0f);
+        for (int i = 13; i <= 16; ++i) {
+            const float* leader   = bus(inst, i);
+            const float* follower = bus(inst, i + 4);
+            for (int n = 0; n < TEST_FRAMES; ++n) {
+                if (std::fabs(follower[n] - leader[n]) > TOLERANCE) {
+                    ntHostSetCycleClock(nullptr);
+                    return fail("bus %d differs from the leader's bus %d by %g at block %d",
+                                i + 4, i, follower[n] - leader[n], b);
+                }
+            }
+        }
+        // Coarse quality: gains step between blocks and hold within them
+        const float* out = bus(inst, 13);
+        if (out[0] != prev && std::all_of(out, out + TEST_FRAMES, [&](float x) { return x == out[0]; })) {
+            ++held;
+        }
+        prev = out[TEST_FRAMES - 1];
+    }
+    ntHostSetCycleClock(nullptr);
+    if (held == 0) {
+        return fail("the governor never reached Coarse");
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── latency_shift ───── */
+// Two independent groups mix the same input; group 2 delays Dest 1 by more
+// than a block, so its bus must be group 1's, shifted by exactly that much.
+static bool testLatencyShift(const char* capturePath) {
+    const int DELAY = 200;  // samples, under the 10 ms Max Delay at 48 kHz
+    const int END   = 50;
+
+    SwmxInstance inst;
+    if (!init(inst, { { "Groups", 2 }, { "Max Delay ms", 10 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13)
+        && set(inst, "1:Dest 1 R", 14) && set(inst, "1:Dest 2 L", 0) && set(inst, "1:Dest 2 R", 0)
+        && set(inst, "2:Input R", 0) && set(inst, "2:Dest 1 L", 15) && set(inst, "2:Dest 1 R", 16)
+        && set(inst, "2:Dest 2 L", 0) && set(inst, "2:Dest 2 R", 0) && set(inst, "2:Dest 1 Delay", DELAY);
+    if (!ok) {
+        return false;
+    }
+    std::vector<float> direct;
+    uint32_t noise = 1;
+    for (int b = 0; b < END; ++b) {
+        std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+        for (int n = 0; n < TEST_FRAMES; ++n) {
+            noise = noise * 1664525u + 1013904223u;
+            bus(inst, 1)[n] = (float)(noise >> 8) / (float)(1u << 24) * 10.0f - 5.0f;
+        }
+        inst.step(TEST_FRAMES);
+        direct.insert(direct.end(), bus(inst, 13), bus(inst, 13) + TEST_FRAMES);
+        for (int n = 0; n < TEST_FRAMES; ++n) {
+            const int   at       = b * TEST_FRAMES + n;
+            const float expected = (at >= DELAY) ? direct[at - DELAY] : 0.0f;
+            if (bus(inst, 15)[n] != expected || bus(inst, 16)[n] != expected) {
+                return fail("delayed bus is %g at frame %d, expected %g", bus(inst, 15)[n], at, expected);
+            }
+        }
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── delay_reset ───── */
+// A Dest Delay ring must not replay audio from before it was bypassed or
+// went idle. Dest 1 carries 5 V through 200 samples, then:
+//   - the delay drops to 0 over silence and returns to 200
+//   - Dest 1 idles until its ring has flushed, and the delay rises to 400
+// After each, Dest 1 has to stay silent while the input does.
+static bool testDelayReset(const char* capturePath) {
+    SwmxInstance inst;
+    if (!init(inst, { { "Max Delay ms", 10 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13)
+        && set(inst, "1:Dest 1 R", 14) && set(inst, "1:Dest 2 L", 0) && set(inst, "1:Dest 2 R", 0)
+        && set(inst, "1:Dest 1 Delay", 200);
+    if (!ok) {
+        return false;
+    }
+    // Runs blocks at `in` volts; with `silent`, Dest 1 must stay at 0
+    auto run = [&](int blocks, float in, bool silent, const char* phase) {
+        for (int b = 0; b < blocks; ++b) {
+            stepDC(inst, in);
+            for (int n = 0; silent && n < TEST_FRAMES; ++n) {
+                if (bus(inst, 13)[n] != 0.0f || bus(inst, 14)[n] != 0.0f) {
+                    return fail("%s: Dest 1 replays %g V at block %d", phase, bus(inst, 13)[n], b);
+                }
+            }
+        }
+        return true;
+    };
+    if (!run(20, 5.0f, false, "signal")) {
+        return false;
+    }
+    set(inst, "1:Dest 1 Delay", 0);
+    if (!run(20, 0.0f, true, "bypassed")) {
+        return false;
+    }
+    set(inst, "1:Dest 1 Delay", 200);
+    if (!run(5, 0.0f, true, "delay restored")) {
+        return false;
+    }
+
+    if (!run(20, 5.0f, false, "signal")) {
+        return false;
+    }
+    set(inst, "1:Active Dest", 2);
+    if (!run(20, 0.0f, false, "idle")) {
+        return false;
+    }
+    set(inst, "1:Dest 1 Delay", 400);
+    set(inst, "1:Active Dest", 1);
+    if (!run(5, 0.0f, true, "delay raised while idle")) {
+        return false;
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── arbitration ───── */
+// One group on four mono destinations (busses 13-16), driven by a Unipolar
+// Control CV on bus 9, MIDI CC 0 and Active Dest in each Arbitration mode
+struct ArbStep {
+    const char* action;
+    int         control;  // Control bus, or -1 to leave it
+    float       cv;
+    int         midi;     // CC value, or -1 for none
+    int         param;    // Active Dest, or 0 to leave it
+    int         mode;     // Arbitration, or -1 to leave it
+    int         expect;   // Destination that must be sounding (1-based)
+};
+
+// The one destination bus carrying signal (1-based), or 0
+static int soundingDest(SwmxInstance& inst) {
+    int found = 0;
+    for (int d = 1; d <= 4; ++d) {
+        if (bus(inst, 12 + d)[TEST_FRAMES - 1] != 0.0f) {
+            if (found) {
+                return 0;
+            }
+            found = d;
+        }
+    }
+    return found;
+}
+
+// Routes Group 1 mono from bus 1 to Dests 1-4 on busses 13-16, with MIDI on
+static bool monoDests(SwmxInstance& inst) {
+    bool ok = set(inst, "1:Input R", 0) && set(inst, "1:MIDI Enable", 1);
+    for (int d = 1; d <= 4 && ok; ++d) {
+        char name[32];
+        snprintf(name, sizeof(name), "1:Dest %d L", d);
+        ok = set(inst, name, (int16_t)(12 + d));
+        snprintf(name, sizeof(name), "1:Dest %d R", d);
+        ok = ok && set(inst, name, 0);
+    }
+    return ok;
+}
+
+static bool testArbitration(const char* capturePath) {
+    static const ArbStep steps[] = {
+        // Last Touched: whichever source moved most recently
+        { "CV 6 V",             9, 6.0f,  -1, 0, -1, 3 },
+        { "CC 40",             -1, 6.0f,  40, 0, -1, 2 },
+        { "Active Dest 4",     -1, 6.0f,  -1, 4, -1, 4 },
+        { "CV 1 V",            -1, 1.0f,  -1, 0, -1, 1 },
+        { "CC 127, CV held",   -1, 1.0f, 127, 0, -1, 4 },
+        // Priority: Control, then MIDI, then Active Dest
+        { "Priority",          -1, 1.0f,  -1, 0,  1, 1 },
+        { "CC 40",             -1, 1.0f,  40, 0, -1, 1 },
+        { "Active Dest 3",     -1, 1.0f,  -1, 3, -1, 1 },
+        { "Control unpatched",  0, 0.0f,  -1, 0, -1, 2 },
+        // CV+MIDI: the last manual choice, stepped on by the Control's position
+        { "CV+MIDI, CV 6 V",    9, 6.0f,  -1, 0,  2, 1 },
+        { "CC 100",            -1, 6.0f, 100, 0, -1, 2 },
+        { "CV 3 V",            -1, 3.0f,  -1, 0, -1, 1 },
+    };
+
+    SwmxInstance inst;
+    if (!init(inst, { { "Destinations", 4 }, { "Ctrl Options", 1 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    if (!monoDests(inst)) {
+        return false;
+    }
+    for (const ArbStep& s : steps) {
+        if (s.control >= 0) set(inst, "1:Control", (int16_t)s.control);
+        if (s.mode >= 0)    set(inst, "1:Arbitration", (int16_t)s.mode);
+        if (s.param > 0)    set(inst, "1:Active Dest", (int16_t)s.param);
+        if (s.midi >= 0)    inst.midiMessage(0xB0, 0, (uint8_t)s.midi);
+        for (int b = 0; b < 2; ++b) {
+            std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+            std::fill(bus(inst, 1), bus(inst, 1) + TEST_FRAMES, 1.0f);
+            std::fill(bus(inst, 9), bus(inst, 9) + TEST_FRAMES, s.cv);
+            inst.step(TEST_FRAMES);
+        }
+        const int dest = soundingDest(inst);
+        if (dest != s.expect) {
+            return fail("%s: Dest %d sounds, expected Dest %d", s.action, dest, s.expect);
+        }
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── array_duck ───── */
+// Two 4-channel arrays: Group 1 (Priority 1, Duck 40 dB) on busses 13-16 and
+// Group 2 on a run that only partly overlaps it. Any shared bus must duck
+// all of Group 2's channels; moving Group 2 clear of the run releases it.
+static bool testArrayDuck(const char* capturePath) {
+    SwmxInstance inst;
+    if (!init(inst, { { "Groups", 2 }, { "Channels", 4 }, { "Ducking", 1 } })
+        || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Dest 1 L", 13) && set(inst, "1:Dest 2 L", 0)
+        && set(inst, "1:Priority", 1) && set(inst, "1:Duck", 40)
+        && set(inst, "2:Input L", 5) && set(inst, "2:Dest 1 L", 15) && set(inst, "2:Dest 2 L", 0);
+    if (!ok) {
+        return false;
+    }
+    // Runs 1 s with Group 2's channels at 1 V; its last channel must settle near `expect`
+    auto run = [&](const char* phase, int lastBus, float expect) {
+        for (int b = 0; b < 400; ++b) {
+            std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+            std::fill(bus(inst, 5), bus(inst, 9), 1.0f);
+            inst.step(TEST_FRAMES);
+        }
+        const float out = bus(inst, lastBus)[TEST_FRAMES - 1];
+        return std::fabs(out - expect) < 0.001f
+            || fail("%s: bus %d is %g V, expected %g V", phase, lastBus, out, expect);
+    };
+    if (!run("overlapping 15-16", 18, 0.01f)) {
+        return false;
+    }
+    set(inst, "2:Dest 1 L", 17);
+    if (!run("clear of 13-16", 20, 1.0f)) {
+        return false;
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── zones ───── */
+// Custom zones with four destinations: CV and MIDI select by the Zone N
+// Start breakpoints, each start belonging to the zone it opens. Unipolar
+// uses 1/2/3 V; Bipolar reads the same table from -5 V, with breakpoints
+// re-entered as -2.5/0/2.5 V.
+struct ZoneStep {
+    const char* action;
+    float       cv;
+    int         midi;     // CC value, or -1 for none
+    int         expect;   // Destination that must be sounding (1-based)
+};
+
+static bool testZones(const char* capturePath) {
+    static const ZoneStep unipolar[] = {
+        { "0.5 V",  0.5f,  -1, 1 },
+        { "1 V",    1.0f,  -1, 2 },
+        { "1.98 V", 1.98f, -1, 2 },
+        { "2 V",    2.0f,  -1, 3 },
+        { "3 V",    3.0f,  -1, 4 },
+        { "9.9 V",  9.9f,  -1, 4 },
+        { "-3 V",  -3.0f,  -1, 1 },
+    };
+    // CC 0-127 spans 0-10 V: CC 13 is 1.02 V, CC 26 is 2.05 V
+    static const ZoneStep midi[] = {
+        { "CC 13",  0.0f,  13, 2 },
+        { "CC 12",  0.0f,  12, 1 },
+        { "CC 26",  0.0f,  26, 3 },
+        { "CC 127", 0.0f, 127, 4 },
+    };
+    static const ZoneStep bipolar[] = {
+        { "-4 V",  -4.0f,  -1, 1 },
+        { "-2.5 V", -2.5f, -1, 2 },
+        { "0 V",    0.0f,  -1, 3 },
+        { "2.4 V",  2.4f,  -1, 3 },
+        { "4.9 V",  4.9f,  -1, 4 },
+    };
+
+    SwmxInstance inst;
+    if (!init(inst, { { "Destinations", 4 }, { "Ctrl Options", 1 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = monoDests(inst) && set(inst, "1:Control", 9) && set(inst, "1:Zones", 1)
+        && set(inst, "1:Zone 2 Start", 10) && set(inst, "1:Zone 3 Start", 20)
+        && set(inst, "1:Zone 4 Start", 30);
+    if (!ok) {
+        return false;
+    }
+    auto run = [&](const ZoneStep* steps, size_t count, const char* phase) {
+        for (size_t i = 0; i < count; ++i) {
+            const ZoneStep& s = steps[i];
+            if (s.midi >= 0) {
+                inst.midiMessage(0xB0, 0, (uint8_t)s.midi);
+            }
+            for (int b = 0; b < 2; ++b) {
+                std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+                std::fill(bus(inst, 1), bus(inst, 1) + TEST_FRAMES, 1.0f);
+                std::fill(bus(inst, 9), bus(inst, 9) + TEST_FRAMES, s.cv);
+                inst.step(TEST_FRAMES);
+            }
+            const int dest = soundingDest(inst);
+            if (dest != s.expect) {
+                return fail("%s, %s: Dest %d sounds, expected Dest %d", phase, s.action, dest, s.expect);
+            }
+        }
+        return true;
+    };
+    if (!run(unipolar, sizeof(unipolar) / sizeof(unipolar[0]), "Unipolar")) {
+        return false;
+    }
+    set(inst, "1:Control", 0);
+    if (!run(midi, sizeof(midi) / sizeof(midi[0]), "MIDI")) {
+        return false;
+    }
+    set(inst, "1:Control", 9);
+    set(inst, "1:Ctrl Type", 1);
+    set(inst, "1:Zone 2 Start", -25);
+    set(inst, "1:Zone 3 Start", 0);
+    set(inst, "1:Zone 4 Start", 25);
+    if (!run(bipolar, sizeof(bipolar) / sizeof(bipolar[0]), "Bipolar")) {
+        return false;
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── clipping ───── */
+// Two groups add the same mono input to bus 13. The clipper shapes their
+// sum once, after both have mixed, and leaves busses SwMx didn't write
+// (bus 20, held at 15 V) alone. A hot sum lands exactly on the Clip Level.
+static float cubicClip(float x, float level) {
+    const float u = std::min(std::max(x / level, -1.5f), 1.5f);
+    return level * u * (1.0f - (4.0f / 27.0f) * u * u);
+}
+
+static float tanhClip(float x, float level) {
+    const float u = std::min(std::max(x / level, -3.0f), 3.0f);
+    return level * u * (27.0f + u * u) / (27.0f + 9.0f * u * u);
+}
+
+static bool testClipping(const char* capturePath) {
+    SwmxInstance inst;
+    if (!init(inst, { { "Groups", 2 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    bool ok = true;
+    for (int g = 1; g <= 2 && ok; ++g) {
+        char name[32];
+        const char* const settings[] = { "Input R", "Dest 1 R", "Dest 2 L", "Dest 2 R" };
+        for (const char* s : settings) {
+            snprintf(name, sizeof(name), "%d:%s", g, s);
+            ok = ok && set(inst, name, 0);
+        }
+        snprintf(name, sizeof(name), "%d:Dest 1 L", g);
+        ok = ok && set(inst, name, 13);
+    }
+    if (!ok) {
+        return false;
+    }
+    // Runs a few blocks at `in` volts and returns where bus 13 ends
+    auto settle = [&](float in) {
+        for (int b = 0; b < 4; ++b) {
+            std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+            std::fill(bus(inst, 1), bus(inst, 1) + TEST_FRAMES, in);
+            std::fill(bus(inst, 20), bus(inst, 20) + TEST_FRAMES, 15.0f);
+            inst.step(TEST_FRAMES);
+        }
+        return bus(inst, 13)[TEST_FRAMES - 1];
+    };
+    auto run = [&](const char* phase, float in, float expect) {
+        const float out = settle(in);
+        if (bus(inst, 20)[TEST_FRAMES - 1] != 15.0f) {
+            return fail("%s: unwritten bus 20 changed to %g V", phase, bus(inst, 20)[TEST_FRAMES - 1]);
+        }
+        return std::fabs(out - expect) <= 1e-4f
+            || fail("%s: bus 13 is %g V, expected %g V", phase, out, expect);
+    };
+
+    // Off: the plain sum, which a per-group clip would shape differently
+    const float sum = settle(4.0f);
+    if (sum < 5.0f || bus(inst, 20)[TEST_FRAMES - 1] != 15.0f) {
+        return fail("Off: two 4 V groups sum to %g V", sum);
+    }
+    set(inst, "Output Clip", 1);
+    set(inst, "Clip Level", 50);
+    if (!run("Cubic 5 V", 4.0f, cubicClip(sum, 5.0f))) {
+        return false;
+    }
+    set(inst, "Output Clip", 2);
+    set(inst, "Clip Level", 100);
+    if (!run("Tanh 10 V", 4.0f, tanhClip(sum, 10.0f))) {
+        return false;
+    }
+    set(inst, "Clip Level", 50);
+    if (!run("Tanh 5 V, hot", 20.0f, 5.0f)) {
+        return false;
+    }
+    set(inst, "Output Clip", 1);
+    if (!run("Cubic 5 V, hot", 20.0f, 5.0f)) {
+        return false;
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── mid_side ───── */
+// A stereo input (3 V left, 1 V right) in Mid/Side routing. Normal routing
+// writes the mono sum M to both channels; Mid/Side writes that same mid to
+// Active Dest and the side S = M (L - R) / (L + R) as +S/-S to Side Dest,
+// so on a shared destination the two decode back to 3:1 stereo.
+static bool testMidSide(const char* capturePath) {
+    SwmxInstance inst;
+    if (!init(inst, { { "Mid/Side", 1 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Dest 1 L", 13) && set(inst, "1:Dest 1 R", 14)
+        && set(inst, "1:Dest 2 L", 15) && set(inst, "1:Dest 2 R", 16);
+    if (!ok) {
+        return false;
+    }
+    // Runs a few blocks; out[d][c] is where Dest d+1's channel c ends
+    float out[2][2];
+    auto settle = [&]() {
+        for (int b = 0; b < 4; ++b) {
+            std::fill(inst.busFrames(), inst.busFrames() + NT_HOST_NUM_BUSSES * TEST_FRAMES, 0.0f);
+            std::fill(bus(inst, 1), bus(inst, 1) + TEST_FRAMES, 3.0f);
+            std::fill(bus(inst, 2), bus(inst, 2) + TEST_FRAMES, 1.0f);
+            inst.step(TEST_FRAMES);
+        }
+        for (int d = 0; d < 2; ++d) {
+            out[d][0] = bus(inst, 13 + 2 * d)[TEST_FRAMES - 1];
+            out[d][1] = bus(inst, 14 + 2 * d)[TEST_FRAMES - 1];
+        }
+    };
+
+    settle();
+    const float mid  = out[0][0];
+    const float side = mid * (3.0f - 1.0f) / (3.0f + 1.0f);
+    if (mid <= 0.0f || out[0][1] != mid || out[1][0] != 0.0f || out[1][1] != 0.0f) {
+        return fail("Normal: Dest 1 is %g/%g V, Dest 2 %g/%g V", out[0][0], out[0][1], out[1][0], out[1][1]);
+    }
+
+    set(inst, "1:Routing", 1);
+    static const struct { int active, side; } routes[] = { { 1, 2 }, { 2, 1 }, { 2, 2 }, { 1, 1 } };
+    for (const auto& rt : routes) {
+        set(inst, "1:Active Dest", (int16_t)rt.active);
+        set(inst, "1:Side Dest", (int16_t)rt.side);
+        settle();
+        float expect[2][2] = {};
+        expect[rt.active - 1][0] += mid;
+        expect[rt.active - 1][1] += mid;
+        expect[rt.side - 1][0]   += side;
+        expect[rt.side - 1][1]   -= side;
+        for (int d = 0; d < 2; ++d) {
+            for (int c = 0; c < 2; ++c) {
+                if (std::fabs(out[d][c] - expect[d][c]) > 1e-5f) {
+                    return fail("Active %d, Side %d: Dest %d %c is %g V, expected %g V", rt.active,
+                                rt.side, d + 1, "LR"[c], out[d][c], expect[d][c]);
+                }
+            }
+        }
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+/* ───── fade_out ───── */
+// Fade sets how fast the destination being entered rises and Fade Out how
+// fast the one being left falls, each an exponential with a time constant of
+// 0.5 s per step. With Fade Out 0 both follow Fade; with Fade Out 4 the old
+// destination lingers on a 2 s tail while the new one still rises in 0.5 s.
+static bool testFadeOut(const char* capturePath) {
+    SwmxInstance inst;
+    if (!init(inst, { { "Fade Options", 1 } }) || !inst.startCapture(capturePath)) {
+        return fail("setup failed");
+    }
+    const bool ok = set(inst, "1:Input R", 0) && set(inst, "1:Dest 1 L", 13) && set(inst, "1:Dest 1 R", 0)
+        && set(inst, "1:Dest 2 L", 15) && set(inst, "1:Dest 2 R", 0) && set(inst, "1:Fade", 1);
+    if (!ok) {
+        return false;
+    }
+    const float samplesPerSec = (float)TEST_SAMPLE_RATE;
+    for (int b = 0; b < 100; ++b) {
+        stepDC(inst, 1.0f);
+    }
+    const float full = bus(inst, 13)[TEST_FRAMES - 1];  // Dest 1 fully open
+    if (full <= 0.0f) {
+        return fail("Dest 1 is silent");
+    }
+
+    // Switches to `to` and follows both destinations for 1 s against the
+    // expected rise (tauIn) and fall (tauOut) from where they were
+    auto fade = [&](const char* phase, int to, float tauIn, float tauOut) {
+        const int rising  = (to == 1) ? 13 : 15;
+        const int falling = (to == 1) ? 15 : 13;
+        const float in0   = bus(inst, rising)[TEST_FRAMES - 1] / full;
+        const float out0  = bus(inst, falling)[TEST_FRAMES - 1] / full;
+        set(inst, "1:Active Dest", (int16_t)to);
+        for (int b = 1; b <= 375; ++b) {
+            stepDC(inst, 1.0f);
+            if (b % 25 != 0) {
+                continue;
+            }
+            const float t    = (float)(b * TEST_FRAMES) / samplesPerSec;
+            const float rise = 1.0f - (1.0f - in0) * std::exp(-t / tauIn);
+            const float fall = out0 * std::exp(-t / tauOut);
+            const float in   = bus(inst, rising)[TEST_FRAMES - 1] / full;
+            const float out  = bus(inst, falling)[TEST_FRAMES - 1] / full;
+            if (std::fabs(in - rise) > 1e-3f || std::fabs(out - fall) > 1e-3f) {
+                return fail("%s: at %.3f s the gains are %g in, %g out; expected %g in, %g out",
+                            phase, t, in, out, rise, fall);
+            }
+        }
+        return true;
+    };
+    if (!fade("Fade Out 0", 2, 0.5f, 0.5f)) {
+        return false;
+    }
+    set(inst, "1:Fade Out", 4);
+    if (!fade("Fade Out 4", 1, 0.5f, 2.0f)) {
+        return false;
+    }
+    set(inst, "1:Fade", 4);
+    set(inst, "1:Fade Out", 1);
+    if (!fade("Fade 4, Fade Out 1", 2, 2.0f, 0.5f)) {
+        return false;
+    }
+    return inst.stopCapture() || fail("can't write %s", capturePath);
+}
+
+struct TestCase {
+    const char* name;
+    bool (*run)(const char* capturePath);
+};
+
+static const TestCase gCases[] = {
+    { "capture_roundtrip", testCaptureRoundtrip },
+    { "retrigger_wrap", testRetriggerWrap },
+    { "follower_leader", testFollowerLeader },
+    { "latency_shift", testLatencyShift },
+    { "delay_reset", testDelayReset },
+    { "arbitration", testArbitration },
+    { "array_duck", testArrayDuck },
+    { "zones", testZones },
+    { "clipping", testClipping },
+    { "mid_side", testMidSide },
+    { "fade_out", testFadeOut },
+};
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: swmx_test CASE capture.swc\n");
+        return 2;
+    }
+    gCase = argv[1];
+    ntHostSetGlobals(TEST_SAMPLE_RATE, TEST_FRAMES);
+
+    for (const TestCase& tc : gCases) {
+        if (!strcmp(gCase, tc.name)) {
+            return tc.run(argv[2]) ? 0 : 1;
+        }
+    }
+    fprintf(stderr, "swmx_test: unknown case \"%s\"\n", gCase);
+    return 2;
+}
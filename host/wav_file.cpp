@@ -0,0 +1,200 @@
+/*
+ * Minimal WAV reader/writer for the SwMx render tool.
+ */
+
+#include "wav_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint16_t le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static const uint16_t WAV_FORMAT_PCM        = 1;
+static const uint16_t WAV_FORMAT_FLOAT      = 3;
+static const uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+/* ───── reader ───── */
+bool WavReader::open(const char* path, std::string& err) {
+    close();
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        err = "can't open";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapSize = (size_t)st.st_size;
+        map = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (!map || map == MAP_FAILED) {
+        map = nullptr;
+        err = "can't map";
+        return false;
+    }
+    // Renders walk the file once, front to back
+    madvise(map, mapSize, MADV_SEQUENTIAL);
+
+    const uint8_t* p   = static_cast<const uint8_t*>(map);
+    const uint8_t* end = p + mapSize;
+    if (mapSize < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) {
+        err = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    uint16_t format = 0;
+    int      bits   = 0;
+    data = nullptr;
+    for (const uint8_t* chunk = p + 12; chunk + 8 <= end;) {
+        const uint32_t len  = le32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        const uint64_t avail = (uint64_t)(end - body);
+        if (memcmp(chunk, "data", 4) != 0 && len > avail) {
+            break;
+        }
+        if (memcmp(chunk, "fmt ", 4) == 0 && len >= 16 && avail >= 16) {
+            format      = le16(body);
+            numChannels = le16(body + 2);
+            rate        = le32(body + 4);
+            bits        = le16(body + 14);
+            if (format == WAV_FORMAT_EXTENSIBLE && len >= 26 && avail >= 26) {
+                format = le16(body + 24);  // first two bytes of the subformat GUID
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            data = body;
+            // Streamed writers leave the size unset; trust the file length
+            const uint64_t dataLen = (len == 0 || len > avail) ? avail : len;
+            bytesPerSample = bits / 8;
+            if (numChannels > 0 && bytesPerSample > 0) {
+                numFrames = dataLen / ((uint64_t)numChannels * bytesPerSample);
+            }
+            break;
+        }
+        chunk = body + len + (len & 1);
+    }
+
+    isFloat = (format == WAV_FORMAT_FLOAT);
+    const bool supported = (format == WAV_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32))
+                        || (isFloat && bits == 32);
+    if (!data || numChannels == 0 || rate == 0 || !supported) {
+        err = "unsupported WAV format (need 16/24/32-bit PCM or 32-bit float)";
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close() {
+    if (map) {
+        munmap(map, mapSize);
+    }
+    map       = nullptr;
+    mapSize   = 0;
+    data      = nullptr;
+    numFrames = 0;
+}
+
+void WavReader::read(uint64_t start, int count, float* dst, int stride, int maxChannels) const {
+    const int used = std::min(numChannels, maxChannels);
+    const int avail = (start >= numFrames) ? 0 : (int)std::min<uint64_t>(count, numFrames - start);
+    const int frameBytes = numChannels * bytesPerSample;
+
+    for (int c = 0; c < used; ++c) {
+        float*         out = dst + c * stride;
+        const uint8_t* in  = data + start * frameBytes + c * bytesPerSample;
+        if (isFloat) {
+            for (int n = 0; n < avail; ++n, in += frameBytes) {
+                float v;
+                memcpy(&v, in, sizeof(v));
+                out[n] = v;
+            }
+        } else if (bytesPerSample == 2) {
+            for (int n = 0; n < avail; ++n, in += frameBytes) {
+                out[n] = (int16_t)le16(in) * (1.0f / 32768.0f);
+            }
+        } else if (bytesPerSample == 3) {
+            for (int n = 0; n < avail; ++n, in += frameBytes) {
+                const int32_t s = (int32_t)(((uint32_t)in[0] << 8) | ((uint32_t)in[1] << 16)
+                                            | ((uint32_t)in[2] << 24)) >> 8;
+                out[n] = s * (1.0f / 8388608.0f);
+            }
+        } else {
+            for (int n = 0; n < avail; ++n, in += frameBytes) {
+                out[n] = (int32_t)le32(in) * (1.0f / 2147483648.0f);
+            }
+        }
+        std::fill(out + avail, out + count, 0.0f);
+    }
+}
+
+/* ───── writer ───── */
+bool WavWriter::open(const char* path, int channels, uint32_t sampleRate) {
+    close();
+    file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    numChannels   = channels;
+    framesWritten = 0;
+    ok            = true;
+
+    // Sizes are patched in close()
+    uint8_t h[44] = {};
+    memcpy(h, "RIFF", 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 16);
+    put16(h + 20, WAV_FORMAT_FLOAT);
+    put16(h + 22, (uint16_t)channels);
+    put32(h + 24, sampleRate);
+    put32(h + 28, sampleRate * channels * 4);
+    put16(h + 32, (uint16_t)(channels * 4));
+    put16(h + 34, 32);
+    memcpy(h + 36, "data", 4);
+    ok = fwrite(h, 1, sizeof(h), file) == sizeof(h);
+    return ok;
+}
+
+bool WavWriter::write(const float* frames, int count) {
+    if (!file) {
+        return false;
+    }
+    const size_t n = (size_t)count * numChannels;
+    ok = ok && fwrite(frames, sizeof(float), n, file) == n;
+    framesWritten += count;
+    return ok;
+}
+
+bool WavWriter::close() {
+    if (!file) {
+        return ok;
+    }
+    const uint64_t dataBytes = framesWritten * numChannels * 4;
+    uint8_t size[4];
+    put32(size, (uint32_t)std::min<uint64_t>(dataBytes + 36, 0xFFFFFFFFu));
+    ok = ok && fseek(file, 4, SEEK_SET) == 0 && fwrite(size, 1, 4, file) == 4;
+    put32(size, (uint32_t)std::min<uint64_t>(dataBytes, 0xFFFFFFFFu));
+    ok = ok && fseek(file, 40, SEEK_SET) == 0 && fwrite(size, 1, 4, file) == 4;
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    return ok;
+}
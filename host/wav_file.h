@@ -0,0 +1,67 @@
+/*
+ * Minimal WAV reader/writer for the SwMx render tool.
+ * Reads 16/24/32-bit PCM and 32-bit float; writes 32-bit float.
+ * Inputs are memory-mapped and decoded straight into the caller's buffers,
+ * so no copy of the file is ever made.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+class WavReader {
+public:
+    WavReader() = default;
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+    ~WavReader() { close(); }
+
+    // Returns false and sets err if the file can't be read or isn't a
+    // supported WAV
+    bool open(const char* path, std::string& err);
+
+    uint32_t sampleRate() const { return rate; }
+    int      channels() const { return numChannels; }
+    uint64_t frames() const { return numFrames; }
+
+    // Deinterleaves `count` frames from `start` into dst: channel c goes to
+    // dst + c * stride. Channels beyond maxChannels are skipped, and frames
+    // past the end of the file are written as silence.
+    void read(uint64_t start, int count, float* dst, int stride, int maxChannels) const;
+
+    void close();
+
+private:
+    void*                map = nullptr;
+    size_t               mapSize = 0;
+    const uint8_t*       data = nullptr;
+    uint32_t             rate = 0;
+    int                  numChannels = 0;
+    int                  bytesPerSample = 0;
+    bool                 isFloat = false;
+    uint64_t             numFrames = 0;
+};
+
+class WavWriter {
+public:
+    WavWriter() = default;
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+    ~WavWriter() { close(); }
+
+    bool open(const char* path, int channels, uint32_t sampleRate);
+
+    // Interleaved frames, `channels` floats each
+    bool write(const float* frames, int count);
+
+    // Patches the chunk sizes. Returns false if any write failed.
+    bool close();
+
+private:
+    FILE*    file = nullptr;
+    int      numChannels = 0;
+    uint64_t framesWritten = 0;
+    bool     ok = true;
+};
@@ -0,0 +1,65 @@
+/*
+ * Work-stealing job queue for the SwMx render tool.
+ * Every worker owns a lane: it takes its own jobs from the back and, once
+ * empty, steals from the front of the other lanes. Jobs are all queued
+ * before the workers start, so an empty sweep of every lane means done.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class WorkStealingQueue {
+public:
+    explicit WorkStealingQueue(int numWorkers) {
+        for (int i = 0; i < numWorkers; ++i) {
+            lanes.emplace_back(new Lane);
+        }
+    }
+
+    // Not thread-safe; call before the workers start
+    void push(int worker, size_t job) {
+        lanes[worker]->jobs.push_back(job);
+    }
+
+    // Next job for `worker`; false when every lane is empty
+    bool pop(int worker, size_t& job) {
+        if (lanes[worker]->take(job, true)) {
+            return true;
+        }
+        const int n = (int)lanes.size();
+        for (int i = 1; i < n; ++i) {
+            if (lanes[(worker + i) % n]->take(job, false)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Lane {
+        std::mutex         lock;
+        std::deque<size_t> jobs;
+
+        bool take(size_t& job, bool back) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (jobs.empty()) {
+                return false;
+            }
+            if (back) {
+                job = jobs.back();
+                jobs.pop_back();
+            } else {
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes;
+};